@@ -0,0 +1,209 @@
+#include "alutables.h"
+#include "opcodes.h"
+#include "lazyflags.h"
+#include "threads.h"
+#include "context.h"
+
+/*
+	Every table entry is worked out with the same rules as the branch based helpers in opcodes.c,
+	including their quirks: DAA never clears Z or C, and ADC/SBC fold the carry into the operand.
+*/
+
+// Repeats M(n) for n counting up from the start, so the tables below can be written out by the preprocessor
+#define REPEAT_4(M, n)		M(n) M((n) + 1) M((n) + 2) M((n) + 3)
+#define REPEAT_16(M, n)		REPEAT_4(M, n) REPEAT_4(M, (n) + 4) REPEAT_4(M, (n) + 8) REPEAT_4(M, (n) + 12)
+#define REPEAT_64(M, n)		REPEAT_16(M, n) REPEAT_16(M, (n) + 16) REPEAT_16(M, (n) + 32) REPEAT_16(M, (n) + 48)
+#define REPEAT_256(M, n)	REPEAT_64(M, n) REPEAT_64(M, (n) + 64) REPEAT_64(M, (n) + 128) REPEAT_64(M, (n) + 192)
+#define REPEAT_512(M)		REPEAT_256(M, 0) REPEAT_256(M, 256)
+#define REPEAT_2048(M)		REPEAT_512(M) REPEAT_256(M, 512) REPEAT_256(M, 768) REPEAT_256(M, 1024) \
+							REPEAT_256(M, 1280) REPEAT_256(M, 1536) REPEAT_256(M, 1792)
+
+#define ZERO_FLAG(value) ((((value) & 0xFF) == 0) ? FLAG_Z : 0)
+
+// INC and DEC
+#define INC_ENTRY(r) (BYTE)(ZERO_FLAG((r) + 1) | ((((r) & 0xF) == 0xF) ? FLAG_H : 0)),
+#define DEC_ENTRY(r) (BYTE)(FLAG_N | ZERO_FLAG((r) - 1) | ((((r) & 0xF) == 0) ? FLAG_H : 0)),
+
+const BYTE mIncFlags[0x100] = { REPEAT_256(INC_ENTRY, 0) };
+const BYTE mDecFlags[0x100] = { REPEAT_256(DEC_ENTRY, 0) };
+
+// Shifts, n is carry << 8 | value
+#define SHIFT_ENTRY(result, carry) (WORD)(((result) & 0xFF) | ((ZERO_FLAG(result) | ((carry) ? FLAG_C : 0)) << 8)),
+#define RLC_ENTRY(n)	SHIFT_ENTRY(((n) << 1) | (((n) & 0xFF) >> 7), (n) & 0x80)
+#define RRC_ENTRY(n)	SHIFT_ENTRY((((n) & 0xFF) >> 1) | (((n) & 0x01) << 7), (n) & 0x01)
+#define RL_ENTRY(n)		SHIFT_ENTRY(((n) << 1) | ((n) >> 8), (n) & 0x80)
+#define RR_ENTRY(n)		SHIFT_ENTRY((((n) & 0xFF) >> 1) | (((n) >> 8) << 7), (n) & 0x01)
+#define SLA_ENTRY(n)	SHIFT_ENTRY((n) << 1, (n) & 0x80)
+#define SRA_ENTRY(n)	SHIFT_ENTRY((((n) & 0xFF) >> 1) | ((n) & 0x80), (n) & 0x01)
+#define SWAP_ENTRY(n)	SHIFT_ENTRY((((n) & 0x0F) << 4) | (((n) & 0xF0) >> 4), 0)
+#define SRL_ENTRY(n)	SHIFT_ENTRY(((n) & 0xFF) >> 1, (n) & 0x01)
+
+const WORD mShiftTable[8][0x200] =
+{
+	{ REPEAT_512(RLC_ENTRY) },
+	{ REPEAT_512(RRC_ENTRY) },
+	{ REPEAT_512(RL_ENTRY) },
+	{ REPEAT_512(RR_ENTRY) },
+	{ REPEAT_512(SLA_ENTRY) },
+	{ REPEAT_512(SRA_ENTRY) },
+	{ REPEAT_512(SWAP_ENTRY) },
+	{ REPEAT_512(SRL_ENTRY) },
+};
+
+// DAA, n is N H C << 8 | A
+#define DAA_A(n)			((n) & 0xFF)
+#define DAA_N(n)			((n) & 0x400)
+#define DAA_H(n)			((n) & 0x200)
+#define DAA_C(n)			((n) & 0x100)
+#define DAA_CARRIES(n)		(DAA_C(n) || (DAA_A(n) > 0x99))
+#define DAA_ADD(n)			(DAA_A(n) + (DAA_CARRIES(n) ? 0x60 : 0) + ((DAA_H(n) || ((DAA_A(n) & 0x0F) > 0x09)) ? 0x06 : 0))
+#define DAA_SUB(n)			(DAA_A(n) - (DAA_C(n) ? 0x60 : 0) - (DAA_H(n) ? 0x06 : 0))
+#define DAA_RESULT(n)		((DAA_N(n) ? DAA_SUB(n) : DAA_ADD(n)) & 0xFF)
+#define DAA_ENTRY(n)		(WORD)(DAA_RESULT(n) | ((ZERO_FLAG(DAA_RESULT(n)) | ((!DAA_N(n) && DAA_CARRIES(n)) ? FLAG_C : 0)) << 8)),
+
+const WORD mDaaTable[0x800] = { REPEAT_2048(DAA_ENTRY) };
+
+// ADD and SUB
+#define ADD_FLAGS(a, r) (BYTE)(ZERO_FLAG((a) + (r)) | (((((a) & 0xF) + ((r) & 0xF)) & 0x10) ? FLAG_H : 0) | (((a) + (r)) > 0xFF ? FLAG_C : 0))
+#define SUB_FLAGS(a, r) (BYTE)(FLAG_N | ZERO_FLAG((a) - (r)) | ((((r) & 0xF) > ((a) & 0xF)) ? FLAG_H : 0) | (((r) > (a)) ? FLAG_C : 0))
+
+BYTE mAddFlags[0x10000];
+BYTE mSubFlags[0x10000];
+
+threadOnce mAluTablesBuilt = ONCE_INITIALIZER;
+
+// 2 x 64k entries is more than compilers like to see in an initializer, so these two are filled in at run time
+ONCE_FUNCTION(buildAluTables)
+{
+	int a, r;
+
+	for (a = 0; a < 0x100; a++)
+	{
+		for (r = 0; r < 0x100; r++)
+		{
+			mAddFlags[(a << 8) | r] = ADD_FLAGS(a, r);
+			mSubFlags[(a << 8) | r] = SUB_FLAGS(a, r);
+		}
+	}
+
+	ONCE_RETURN;
+}
+
+// Every instance calls this when it powers on, only the first call builds the tables they all share
+void initializeAluTables()
+{
+	RUN_ONCE(&mAluTablesBuilt, buildAluTables);
+}
+
+// Replaces the flags in the upper nibble of F, lazily worked out flags are brought up to date first so keep is right
+#define WRITE_FLAGS(keep, flags) \
+	RESOLVE_FLAGS(); \
+	registerAF.lo = (registerAF.lo & ((keep) | 0x0F)) | (flags);
+
+// C as 0 or 1, F has to be up to date
+#define CARRY_BIT ((registerAF.lo & FLAG_C) >> 4)
+
+BYTE tableINC(BYTE r)
+{
+	WRITE_FLAGS(FLAG_C, mIncFlags[r]);
+	return r + 1;
+}
+
+BYTE tableDEC(BYTE r)
+{
+	WRITE_FLAGS(FLAG_C, mDecFlags[r]);
+	return r - 1;
+}
+
+void tableADD(BYTE r)
+{
+	WRITE_FLAGS(0, mAddFlags[(registerAF.hi << 8) | r]);
+	registerAF.hi += r;
+}
+
+void tableADC(BYTE r)
+{
+	RESOLVE_FLAGS();
+	tableADD(r + CARRY_BIT);
+}
+
+void tableSUB(BYTE r)
+{
+	WRITE_FLAGS(0, mSubFlags[(registerAF.hi << 8) | r]);
+	registerAF.hi -= r;
+}
+
+void tableSBC(BYTE r)
+{
+	RESOLVE_FLAGS();
+	tableSUB(r + CARRY_BIT);
+}
+
+void tableCP(BYTE r)
+{
+	WRITE_FLAGS(0, mSubFlags[(registerAF.hi << 8) | r]);
+}
+
+// Like the helpers they replace, the shifts take the 8 cycles of a CB instruction
+BYTE tableShift(int shift, WORD index)
+{
+	WORD entry = mShiftTable[shift][index];
+
+	clock += 8;
+	WRITE_FLAGS(0, entry >> 8);
+
+	return (BYTE)entry;
+}
+
+BYTE tableRLC(BYTE r)
+{
+	return tableShift(SHIFT_RLC, r);
+}
+
+BYTE tableRRC(BYTE r)
+{
+	return tableShift(SHIFT_RRC, r);
+}
+
+BYTE tableRL(BYTE r)
+{
+	RESOLVE_FLAGS();
+	return tableShift(SHIFT_RL, (CARRY_BIT << 8) | r);
+}
+
+BYTE tableRR(BYTE r)
+{
+	RESOLVE_FLAGS();
+	return tableShift(SHIFT_RR, (CARRY_BIT << 8) | r);
+}
+
+BYTE tableSLA(BYTE r)
+{
+	return tableShift(SHIFT_SLA, r);
+}
+
+BYTE tableSRA(BYTE r)
+{
+	return tableShift(SHIFT_SRA, r);
+}
+
+BYTE tableSWAP(BYTE r)
+{
+	return tableShift(SHIFT_SWAP, r);
+}
+
+BYTE tableSRL(BYTE r)
+{
+	return tableShift(SHIFT_SRL, r);
+}
+
+// N, H and C sit next to each other in F so they make the upper bits of the index as they are
+void tableDAA()
+{
+	RESOLVE_FLAGS();
+
+	WORD entry = mDaaTable[(((registerAF.lo >> 4) & 0x07) << 8) | registerAF.hi];
+
+	registerAF.hi = (BYTE)entry;
+	registerAF.lo = (registerAF.lo & ~FLAG_H) | (entry >> 8);
+}
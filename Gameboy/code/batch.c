@@ -0,0 +1,793 @@
+#include "batch.h"
+#include "cartridge.h"
+#include "cpu.h"
+#include "opcodes.h"
+#include "blockcache.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "lazyflags.h"
+#include <stdlib.h>
+
+/*
+	The lanes are worked on a vector at a time. AVX2 does 32 lanes per instruction, SSE2 is there on every
+	x86-64 and does 16, anything else goes one lane at a time through the same code.
+*/
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+typedef __m256i laneVector;
+#define VECTOR_BYTES			32
+#define VECTOR_LOAD(p)			_mm256_loadu_si256((const __m256i *)(p))
+#define VECTOR_STORE(p, v)		_mm256_storeu_si256((__m256i *)(p), v)
+#define VECTOR_SPLAT(x)			_mm256_set1_epi8((char)(x))
+#define VECTOR_ADD(a, b)		_mm256_add_epi8(a, b)
+#define VECTOR_SUB(a, b)		_mm256_sub_epi8(a, b)
+#define VECTOR_AND(a, b)		_mm256_and_si256(a, b)
+#define VECTOR_OR(a, b)			_mm256_or_si256(a, b)
+#define VECTOR_XOR(a, b)		_mm256_xor_si256(a, b)
+#define VECTOR_EQUAL(a, b)		_mm256_cmpeq_epi8(a, b)
+#define VECTOR_MAX(a, b)		_mm256_max_epu8(a, b)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+
+typedef __m128i laneVector;
+#define VECTOR_BYTES			16
+#define VECTOR_LOAD(p)			_mm_loadu_si128((const __m128i *)(p))
+#define VECTOR_STORE(p, v)		_mm_storeu_si128((__m128i *)(p), v)
+#define VECTOR_SPLAT(x)			_mm_set1_epi8((char)(x))
+#define VECTOR_ADD(a, b)		_mm_add_epi8(a, b)
+#define VECTOR_SUB(a, b)		_mm_sub_epi8(a, b)
+#define VECTOR_AND(a, b)		_mm_and_si128(a, b)
+#define VECTOR_OR(a, b)			_mm_or_si128(a, b)
+#define VECTOR_XOR(a, b)		_mm_xor_si128(a, b)
+#define VECTOR_EQUAL(a, b)		_mm_cmpeq_epi8(a, b)
+#define VECTOR_MAX(a, b)		_mm_max_epu8(a, b)
+#else
+typedef BYTE laneVector;
+#define VECTOR_BYTES			1
+#define VECTOR_LOAD(p)			(*(p))
+#define VECTOR_STORE(p, v)		(*(p) = (v))
+#define VECTOR_SPLAT(x)			((BYTE)(x))
+#define VECTOR_ADD(a, b)		((BYTE)((a) + (b)))
+#define VECTOR_SUB(a, b)		((BYTE)((a) - (b)))
+#define VECTOR_AND(a, b)		((BYTE)((a) & (b)))
+#define VECTOR_OR(a, b)			((BYTE)((a) | (b)))
+#define VECTOR_XOR(a, b)		((BYTE)((a) ^ (b)))
+#define VECTOR_EQUAL(a, b)		((BYTE)(((a) == (b)) ? 0xFF : 0x00))
+#define VECTOR_MAX(a, b)		((BYTE)(((a) > (b)) ? (a) : (b)))
+#endif
+
+// Comparisons give 0xFF in a lane where they hold, VECTOR_FLAG turns that into the flag bit
+#define VECTOR_NOT(a)			VECTOR_XOR(a, VECTOR_SPLAT(0xFF))
+#define VECTOR_GREATER(a, b)	VECTOR_NOT(VECTOR_EQUAL(VECTOR_MAX(a, b), b))
+#define VECTOR_ZERO(a)			VECTOR_EQUAL(a, VECTOR_SPLAT(0))
+#define VECTOR_FLAG(mask, flag)	VECTOR_AND(mask, VECTOR_SPLAT(flag))
+
+// The register arrays are padded so the last vector never reads past them
+#define BATCH_ALIGN 32
+
+#include "context.h"
+
+// The operation in bits 3 - 5 of the ALU opcodes, 0x80 - 0xBF and the ones that take a byte
+#define ALU_OPERATION_ADD 0
+#define ALU_OPERATION_ADC 1
+#define ALU_OPERATION_SUB 2
+#define ALU_OPERATION_SBC 3
+#define ALU_OPERATION_AND 4
+#define ALU_OPERATION_XOR 5
+#define ALU_OPERATION_OR  6
+#define ALU_OPERATION_CP  7
+
+struct batch
+{
+	GameBoy **instances;
+	int lanes;
+	int width;
+
+	// Registers of the lanes in the group, PC and clock are the same for all of them and kept once below
+	BYTE *a, *f, *b, *c, *d, *e, *h, *l;
+	WORD *sp;
+	BYTE *registers[8];		// in the order opcodes encode them, (HL) has no register
+	CYCLES *nextEvent;		// mNextEvent of each lane when it was last run on its own
+	CYCLES *target;			// where each lane stops in this run
+
+	// Every member is at pc on the same cycle, and all of them are halted or none are
+	int *members;
+	int memberCount;
+	WORD pc;
+	CYCLES cycles;
+	int halted;
+	CYCLES end;				// the target of the members
+	CYCLES until;			// earliest event of any member, or end
+	int banksAgree;			// every member has the same ROM bank mapped
+
+	// Where each member ended up after the group ran something lane by lane, and whether it ran at all
+	WORD *lanePC;
+	CYCLES *laneClock;
+	BYTE *laneHalted;
+	BYTE *ran;
+
+	batchStats stats;
+};
+
+/* ------ VECTOR INSTRUCTIONS ------ */
+
+void vectorCopy(batch *group, BYTE *to, BYTE *from)
+{
+	int i;
+
+	for (i = 0; i < group->width; i += VECTOR_BYTES)
+	{
+		VECTOR_STORE(&to[i], VECTOR_LOAD(&from[i]));
+	}
+}
+
+void vectorSet(batch *group, BYTE *to, BYTE value)
+{
+	laneVector splat = VECTOR_SPLAT(value);
+	int i;
+
+	for (i = 0; i < group->width; i += VECTOR_BYTES)
+	{
+		VECTOR_STORE(&to[i], splat);
+	}
+}
+
+// The 8 bit ALU on A, with the same flags the helpers in opcodes.c give. The low nibble of F is left alone
+void vectorAlu(batch *group, int operation, BYTE *source, BYTE immediate)
+{
+	laneVector low = VECTOR_SPLAT(0x0F);
+	int i;
+
+	for (i = 0; i < group->width; i += VECTOR_BYTES)
+	{
+		laneVector a = VECTOR_LOAD(&group->a[i]);
+		laneVector f = VECTOR_LOAD(&group->f[i]);
+		laneVector r = source ? VECTOR_LOAD(&source[i]) : VECTOR_SPLAT(immediate);
+		laneVector result;
+		laneVector flags;
+
+		// ADC and SBC are ADD and SUB of the operand plus carry, which wraps like it does in the helpers
+		if ((operation == ALU_OPERATION_ADC) || (operation == ALU_OPERATION_SBC))
+		{
+			r = VECTOR_ADD(r, VECTOR_AND(VECTOR_EQUAL(VECTOR_AND(f, VECTOR_SPLAT(FLAG_C)), VECTOR_SPLAT(FLAG_C)), VECTOR_SPLAT(1)));
+		}
+
+		switch (operation)
+		{
+		case ALU_OPERATION_ADD:
+		case ALU_OPERATION_ADC:
+			result = VECTOR_ADD(a, r);
+			flags = VECTOR_OR(VECTOR_FLAG(VECTOR_GREATER(a, result), FLAG_C),
+				VECTOR_FLAG(VECTOR_EQUAL(VECTOR_AND(VECTOR_ADD(VECTOR_AND(a, low), VECTOR_AND(r, low)), VECTOR_SPLAT(0x10)), VECTOR_SPLAT(0x10)), FLAG_H));
+			break;
+		case ALU_OPERATION_SUB:
+		case ALU_OPERATION_SBC:
+		case ALU_OPERATION_CP:
+			result = VECTOR_SUB(a, r);
+			flags = VECTOR_OR(VECTOR_OR(VECTOR_SPLAT(FLAG_N), VECTOR_FLAG(VECTOR_GREATER(r, a), FLAG_C)),
+				VECTOR_FLAG(VECTOR_GREATER(VECTOR_AND(r, low), VECTOR_AND(a, low)), FLAG_H));
+			break;
+		case ALU_OPERATION_AND:
+			result = VECTOR_AND(a, r);
+			flags = VECTOR_SPLAT(FLAG_H);
+			break;
+		case ALU_OPERATION_XOR:
+			result = VECTOR_XOR(a, r);
+			flags = VECTOR_SPLAT(0);
+			break;
+		default:
+			result = VECTOR_OR(a, r);
+			flags = VECTOR_SPLAT(0);
+			break;
+		}
+
+		flags = VECTOR_OR(flags, VECTOR_FLAG(VECTOR_ZERO(result), FLAG_Z));
+		VECTOR_STORE(&group->f[i], VECTOR_OR(VECTOR_AND(f, low), flags));
+
+		if (operation != ALU_OPERATION_CP)
+		{
+			VECTOR_STORE(&group->a[i], result);
+		}
+	}
+}
+
+// INC and DEC of an 8 bit register, C stays as it was
+void vectorIncDec(batch *group, BYTE *r, int decrement)
+{
+	laneVector low = VECTOR_SPLAT(0x0F);
+	int i;
+
+	for (i = 0; i < group->width; i += VECTOR_BYTES)
+	{
+		laneVector value = VECTOR_LOAD(&r[i]);
+		laneVector f = VECTOR_AND(VECTOR_LOAD(&group->f[i]), VECTOR_SPLAT(0x0F | FLAG_C));
+		laneVector result;
+
+		if (decrement)
+		{
+			result = VECTOR_SUB(value, VECTOR_SPLAT(1));
+			f = VECTOR_OR(f, VECTOR_OR(VECTOR_SPLAT(FLAG_N), VECTOR_FLAG(VECTOR_ZERO(VECTOR_AND(value, low)), FLAG_H)));
+		}
+		else
+		{
+			result = VECTOR_ADD(value, VECTOR_SPLAT(1));
+			f = VECTOR_OR(f, VECTOR_FLAG(VECTOR_EQUAL(VECTOR_AND(value, low), low), FLAG_H));
+		}
+
+		VECTOR_STORE(&group->f[i], VECTOR_OR(f, VECTOR_FLAG(VECTOR_ZERO(result), FLAG_Z)));
+		VECTOR_STORE(&r[i], result);
+	}
+}
+
+// CPL, SCF and CCF
+void vectorFlags(batch *group, BYTE opcode)
+{
+	int i;
+
+	for (i = 0; i < group->width; i += VECTOR_BYTES)
+	{
+		laneVector f = VECTOR_LOAD(&group->f[i]);
+
+		if (opcode == 0x2F)
+		{
+			VECTOR_STORE(&group->a[i], VECTOR_NOT(VECTOR_LOAD(&group->a[i])));
+			f = VECTOR_OR(f, VECTOR_SPLAT(FLAG_N | FLAG_H));
+		}
+		else if (opcode == 0x37)
+		{
+			f = VECTOR_OR(VECTOR_AND(f, VECTOR_SPLAT(0x0F | FLAG_Z)), VECTOR_SPLAT(FLAG_C));
+		}
+		else
+		{
+			f = VECTOR_XOR(VECTOR_AND(f, VECTOR_SPLAT(0x0F | FLAG_Z | FLAG_C)), VECTOR_SPLAT(FLAG_C));
+		}
+
+		VECTOR_STORE(&group->f[i], f);
+	}
+}
+
+// Runs an instruction for every lane at once if it only works on registers. Returns 0 when it has to go lane by lane
+int runVectorOpcode(batch *group, BYTE opcode, BYTE operand)
+{
+	BYTE *to = group->registers[(opcode >> 3) & 0x07];
+	BYTE *from = group->registers[opcode & 0x07];
+
+	// LD r, r. (HL) on either side and HALT go lane by lane
+	if ((opcode >= 0x40) && (opcode < 0x80))
+	{
+		if (!to || !from)
+		{
+			return 0;
+		}
+
+		if (to != from)
+		{
+			vectorCopy(group, to, from);
+		}
+		return 1;
+	}
+
+	// ALU A, r
+	if ((opcode >= 0x80) && (opcode < 0xC0))
+	{
+		if (!from)
+		{
+			return 0;
+		}
+
+		vectorAlu(group, (opcode >> 3) & 0x07, from, 0);
+		return 1;
+	}
+
+	switch (opcode & 0xC7)
+	{
+	case 0xC6:	// ALU A, n
+		vectorAlu(group, (opcode >> 3) & 0x07, NULL, operand);
+		return 1;
+	case 0x04:	// INC r
+	case 0x05:	// DEC r
+		if (!to)
+		{
+			return 0;
+		}
+
+		vectorIncDec(group, to, opcode & 0x01);
+		return 1;
+	case 0x06:	// LD r, n
+		if (!to)
+		{
+			return 0;
+		}
+
+		vectorSet(group, to, operand);
+		return 1;
+	}
+
+	switch (opcode)
+	{
+	case 0x00:	// NOP
+		return 1;
+	case 0x2F:	// CPL
+	case 0x37:	// SCF
+	case 0x3F:	// CCF
+		vectorFlags(group, opcode);
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* ------ LANES ------ */
+
+// Puts the group's copy of a lane back into its instance and selects it, so it can run on its own
+void writeLane(batch *group, int lane)
+{
+	GameBoy *instance = group->instances[lane];
+
+	instance->af.hi = group->a[lane];
+	instance->af.lo = group->f[lane];
+	instance->bc.hi = group->b[lane];
+	instance->bc.lo = group->c[lane];
+	instance->de.hi = group->d[lane];
+	instance->de.lo = group->e[lane];
+	instance->hl.hi = group->h[lane];
+	instance->hl.lo = group->l[lane];
+	instance->sp.pair = group->sp[lane];
+	instance->pc.pair = group->pc;
+	instance->cycles = group->cycles;
+	instance->lazyFlags.operation = LAZY_NONE;
+
+	selectGameBoy(instance);
+}
+
+// Takes the registers of a lane back from its instance and notes where it ended up
+void readLane(batch *group, int lane)
+{
+	selectGameBoy(group->instances[lane]);
+	RESOLVE_FLAGS();
+
+	group->a[lane] = registerAF.hi;
+	group->f[lane] = registerAF.lo;
+	group->b[lane] = registerBC.hi;
+	group->c[lane] = registerBC.lo;
+	group->d[lane] = registerDE.hi;
+	group->e[lane] = registerDE.lo;
+	group->h[lane] = registerHL.hi;
+	group->l[lane] = registerHL.lo;
+	group->sp[lane] = SP.pair;
+	group->nextEvent[lane] = mNextEvent;
+
+	group->lanePC[lane] = PC.pair;
+	group->laneClock[lane] = clock;
+	group->laneHalted[lane] = halt ? 1 : 0;
+	group->ran[lane] = 1;
+}
+
+int sameLanePlace(batch *group, int lane, int other)
+{
+	return (group->lanePC[lane] == group->lanePC[other]) && (group->laneClock[lane] == group->laneClock[other])
+		&& (group->laneHalted[lane] == group->laneHalted[other]);
+}
+
+// Works out the earliest event of the members and whether they all have the same ROM bank
+void updateGroup(batch *group)
+{
+	WORD bank = group->instances[group->members[0]]->mbc.romBank;
+	int k;
+
+	group->until = group->end;
+	group->banksAgree = 1;
+
+	for (k = 0; k < group->memberCount; k++)
+	{
+		int lane = group->members[k];
+
+		if (group->nextEvent[lane] < group->until)
+		{
+			group->until = group->nextEvent[lane];
+		}
+
+		if (group->instances[lane]->mbc.romBank != bank)
+		{
+			group->banksAgree = 0;
+		}
+	}
+}
+
+/*
+	After some of the members ran on their own, keeps the ones that ended up where most of them did and lets
+	the others go. The majority is found with a single voting pass, when there is none the group goes with
+	whichever place the vote ends on.
+*/
+void settleGroup(batch *group)
+{
+	int candidate = -1;
+	int votes = 0;
+	int kept = 0;
+	int k;
+
+	for (k = 0; k < group->memberCount; k++)
+	{
+		int lane = group->members[k];
+
+		if (!group->ran[lane])
+		{
+			group->lanePC[lane] = group->pc;
+			group->laneClock[lane] = group->cycles;
+			group->laneHalted[lane] = (BYTE)group->halted;
+		}
+
+		if (votes == 0)
+		{
+			candidate = lane;
+			votes = 1;
+		}
+		else
+		{
+			votes += sameLanePlace(group, lane, candidate) ? 1 : -1;
+		}
+	}
+
+	for (k = 0; k < group->memberCount; k++)
+	{
+		int lane = group->members[k];
+
+		if (sameLanePlace(group, lane, candidate))
+		{
+			group->members[kept++] = lane;
+		}
+		else
+		{
+			// Its instance has to be up to date before it runs on its own
+			if (!group->ran[lane])
+			{
+				writeLane(group, lane);
+			}
+			group->stats.divergences++;
+		}
+
+		group->ran[lane] = 0;
+	}
+
+	group->memberCount = kept;
+	group->pc = group->lanePC[candidate];
+	group->cycles = group->laneClock[candidate];
+	group->halted = group->laneHalted[candidate];
+
+	updateGroup(group);
+}
+
+// Runs the instruction at PC lane by lane with the interpreter
+void stepLanes(batch *group)
+{
+	int k;
+
+	for (k = 0; k < group->memberCount; k++)
+	{
+		int lane = group->members[k];
+
+		writeLane(group, lane);
+		stepInstruction();
+		readLane(group, lane);
+	}
+
+	group->stats.scalarSteps++;
+	settleGroup(group);
+}
+
+// Runs the events of every member that has one due, which can take some of them elsewhere
+void runLaneEvents(batch *group)
+{
+	int due = 0;
+	int k;
+
+	for (k = 0; k < group->memberCount; k++)
+	{
+		int lane = group->members[k];
+
+		if (group->cycles >= group->nextEvent[lane])
+		{
+			writeLane(group, lane);
+			runEvents();
+			readLane(group, lane);
+			due = 1;
+		}
+	}
+
+	if (due)
+	{
+		settleGroup(group);
+	}
+}
+
+/* ------ GROUP ------ */
+
+/*
+	Picks the lanes that are at the same PC on the same cycle and halted or not alike, taking the biggest
+	such set. A group of one would only be slower than the lane running on its own, so it takes at least two.
+*/
+void formGroup(batch *group)
+{
+	int best = -1;
+	int bestCount = 1;
+	int i, j;
+
+	group->memberCount = 0;
+
+	for (i = 0; i < group->lanes; i++)
+	{
+		GameBoy *lane = group->instances[i];
+		int count = 0;
+
+		if (lane->isStopped)
+		{
+			continue;
+		}
+
+		for (j = i; j < group->lanes; j++)
+		{
+			GameBoy *other = group->instances[j];
+
+			if (!other->isStopped && (other->pc.pair == lane->pc.pair) && (other->cycles == lane->cycles) && (!other->halted == !lane->halted))
+			{
+				count++;
+			}
+		}
+
+		if (count > bestCount)
+		{
+			best = i;
+			bestCount = count;
+		}
+	}
+
+	if (best < 0)
+	{
+		return;
+	}
+
+	group->pc = group->instances[best]->pc.pair;
+	group->cycles = group->instances[best]->cycles;
+	group->halted = group->instances[best]->halted ? 1 : 0;
+	group->end = group->target[best];
+
+	for (i = best; i < group->lanes; i++)
+	{
+		GameBoy *lane = group->instances[i];
+
+		if (!lane->isStopped && (lane->pc.pair == group->pc) && (lane->cycles == group->cycles) && (!lane->halted == !group->halted))
+		{
+			group->members[group->memberCount++] = i;
+			readLane(group, i);
+			group->ran[i] = 0;
+		}
+	}
+
+	group->stats.groupedLanes += group->memberCount;
+	updateGroup(group);
+}
+
+void runGroup(batch *group)
+{
+	while ((group->memberCount > 1) && (group->cycles < group->end))
+	{
+		// Halted lanes skip to the step before the first event, then step once like skipHalt and cpuStep do
+		if (group->halted)
+		{
+			if (group->until > group->cycles)
+			{
+				group->cycles += ((group->until - group->cycles - 1) / 4) * 4;
+			}
+
+			group->cycles += 4;
+			group->stats.vectorSteps++;
+		}
+		else
+		{
+			BYTE opcode;
+			BYTE operand = 0;
+			int length;
+
+			// Only the shared ROM is known to hold the same code for every lane
+			if ((group->pc >= 0x8000) || !group->banksAgree)
+			{
+				stepLanes(group);
+				continue;
+			}
+
+			selectGameBoy(group->instances[group->members[0]]);
+			opcode = readMemory(group->pc);
+			length = 1 + mOpcodes[opcode].operands;
+
+			if ((group->pc + length > 0x8000) || (length > 2))
+			{
+				stepLanes(group);
+				continue;
+			}
+
+			if (length == 2)
+			{
+				operand = readMemory(group->pc + 1);
+			}
+
+			if (!runVectorOpcode(group, opcode, operand))
+			{
+				stepLanes(group);
+				continue;
+			}
+
+			group->pc += length;
+			group->cycles += mOpcodeCycles[opcode];
+			group->stats.vectorSteps++;
+		}
+
+		if (group->cycles >= group->until)
+		{
+			runLaneEvents(group);
+		}
+	}
+}
+
+/* ------ BATCH ------ */
+
+batch *createBatch(int lanes, char *rom)
+{
+	GameBoy *current = gb;
+	batch *created;
+	BYTE *bytes;
+	int width = ((lanes + BATCH_ALIGN - 1) / BATCH_ALIGN) * BATCH_ALIGN;
+	int i;
+
+	if (lanes < 1)
+	{
+		return NULL;
+	}
+
+	created = (batch*)calloc(1, sizeof(batch));
+	if (!created)
+	{
+		return NULL;
+	}
+
+	created->lanes = lanes;
+	created->width = width;
+	created->instances = (GameBoy**)calloc(lanes, sizeof(GameBoy*));
+
+	// One block holds the eight byte registers, ran and laneHalted for every lane
+	bytes = (BYTE*)calloc(10, width);
+	created->sp = (WORD*)calloc(width, sizeof(WORD));
+	created->lanePC = (WORD*)calloc(width, sizeof(WORD));
+	created->nextEvent = (CYCLES*)calloc(width, sizeof(CYCLES));
+	created->target = (CYCLES*)calloc(width, sizeof(CYCLES));
+	created->laneClock = (CYCLES*)calloc(width, sizeof(CYCLES));
+	created->members = (int*)calloc(width, sizeof(int));
+
+	created->a = bytes;
+	if (bytes)
+	{
+		created->f = bytes + width;
+		created->b = bytes + 2 * width;
+		created->c = bytes + 3 * width;
+		created->d = bytes + 4 * width;
+		created->e = bytes + 5 * width;
+		created->h = bytes + 6 * width;
+		created->l = bytes + 7 * width;
+		created->ran = bytes + 8 * width;
+		created->laneHalted = bytes + 9 * width;
+	}
+
+	created->registers[0] = created->b;
+	created->registers[1] = created->c;
+	created->registers[2] = created->d;
+	created->registers[3] = created->e;
+	created->registers[4] = created->h;
+	created->registers[5] = created->l;
+	created->registers[6] = NULL;
+	created->registers[7] = created->a;
+
+	if (!created->instances || !bytes || !created->sp || !created->lanePC || !created->nextEvent
+		|| !created->target || !created->laneClock || !created->members)
+	{
+		created->lanes = 0;
+		destroyBatch(created);
+		return NULL;
+	}
+
+	// The first lane loads the cartridge, if there is one, and the rest run from its copy
+	for (i = 0; i < lanes; i++)
+	{
+		created->instances[i] = createGameBoy();
+
+		if (!created->instances[i] || ((i == 0) && rom && !readROM(rom)))
+		{
+			created->lanes = i + 1;
+			destroyBatch(created);
+			selectGameBoy(current);
+			return NULL;
+		}
+
+		if (i > 0)
+		{
+			shareCartridge(created->instances[0]);
+		}
+	}
+
+	selectGameBoy(current);
+	return created;
+}
+
+void destroyBatch(batch *destroyed)
+{
+	int i;
+
+	if (!destroyed)
+	{
+		return;
+	}
+
+	// The first lane owns the cartridge the others share, it goes last
+	for (i = destroyed->lanes - 1; i >= 0; i--)
+	{
+		destroyGameBoy(destroyed->instances[i]);
+	}
+
+	free(destroyed->instances);
+	free(destroyed->a);
+	free(destroyed->sp);
+	free(destroyed->lanePC);
+	free(destroyed->nextEvent);
+	free(destroyed->target);
+	free(destroyed->laneClock);
+	free(destroyed->members);
+	free(destroyed);
+}
+
+GameBoy *batchInstance(batch *group, int lane)
+{
+	return group->instances[lane];
+}
+
+int batchLanes(batch *group)
+{
+	return group->lanes;
+}
+
+void runBatch(batch *group, int cycles)
+{
+	GameBoy *current = gb;
+	int i, k;
+
+	for (i = 0; i < group->lanes; i++)
+	{
+		group->target[i] = group->instances[i]->cycles + cycles;
+	}
+
+	formGroup(group);
+	runGroup(group);
+
+	// The members go back into their instances, then every lane that isn't done yet finishes on its own
+	for (k = 0; k < group->memberCount; k++)
+	{
+		writeLane(group, group->members[k]);
+	}
+	group->memberCount = 0;
+
+	for (i = 0; i < group->lanes; i++)
+	{
+		selectGameBoy(group->instances[i]);
+
+		if (clock < group->target[i])
+		{
+			cpuRun((int)(group->target[i] - clock));
+		}
+	}
+
+	group->stats.runs++;
+	selectGameBoy(current);
+}
+
+batchStats getBatchStats(batch *group)
+{
+	return group->stats;
+}
@@ -0,0 +1,342 @@
+#include "blockcache.h"
+#include "cartridge.h"
+#include "memory.h"
+#include "cpu.h"
+#include <string.h>
+
+#include "context.h"
+
+/*
+	The block cache keeps runs of straight line code that have already been fetched and decoded so
+	the cpu doesn't have to go through readMemory and the operand table for every instruction again.
+	Blocks are found by the address of their first instruction and the bank that address was mapped
+	to, the cache is direct mapped so a block that collides with another one simply replaces it.
+*/
+
+// Cycles each handler adds to clock. Conditional jumps, calls and returns are listed with the branch not taken
+// and CB is listed for a register, it takes 8 more for (HL)
+BYTE mOpcodeCycles[256] =
+{
+//	 0   1   2   3   4   5   6   7   8   9   a   b   c   d   e   f
+	 4, 12,  8,  8,  4,  4,  8,  4, 20,  8,  8,  8,  4,  4,  8,  4,	// 0x00
+	 4, 12,  8,  8,  4,  4,  8,  4, 12,  8,  8,  8,  4,  4,  8,  4,	// 0x10
+	 8, 12, 24,  8,  4,  4,  8,  4,  8,  8, 24,  8,  4,  4,  8,  4,	// 0x20
+	 8, 12, 24,  8, 12, 12, 12,  4,  8,  8, 24,  8,  4,  4,  8,  4,	// 0x30
+	 4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4,	// 0x40
+	 4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4,	// 0x50
+	 4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4,	// 0x60
+	 8,  8,  8,  8,  8,  8,  4,  8,  4,  4,  4,  4,  4,  4,  8,  4,	// 0x70
+	 4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4,	// 0x80
+	 4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4,	// 0x90
+	 4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4,	// 0xa0
+	 4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,	// 0xb0
+	 8, 12, 12, 16, 12, 16,  8, 16,  8, 16, 12,  8, 12, 40,  8, 16,	// 0xc0
+	 8, 12, 12,  4, 12,  8,  8, 16,  8, 16, 12,  4, 12,  4,  8, 16,	// 0xd0
+	12, 12,  8,  4,  4, 16,  8, 16, 16,  4, 16,  4,  4,  4,  8, 16,	// 0xe0
+	12, 12,  8,  4,  4, 16,  8, 16, 12,  8, 16,  4,  4,  4,  8, 16,	// 0xf0
+};
+
+void flushBlockCache()
+{
+	memset(mBlocks, 0, sizeof(mBlocks));
+	memset(mPageVersion, 0, sizeof(mPageVersion));
+	memset(mCodeBytes, 0, sizeof(mCodeBytes));
+}
+
+// The bank that is mapped in at an address right now, used as part of the key of a block
+WORD blockBank(WORD address)
+{
+	if ((address >= 0x4000) && (address < 0x8000))
+	{
+		return mMBC.romBank;
+	}
+	else if ((address >= 0xA000) && (address < 0xC000))
+	{
+		return mMBC.ramBank;
+	}
+
+	return 0;
+}
+
+/*
+	Blocks never cross from one area of the memory map into another since the other side can be
+	banked differently. Echo RAM, OAM and the I/O ports aren't cached at all, returns 0 for those.
+*/
+unsigned int blockAreaEnd(WORD address)
+{
+	if (address < 0x4000)
+	{
+		return 0x4000;
+	}
+	else if (address < 0x8000)
+	{
+		return 0x8000;
+	}
+	else if (address < 0xA000)
+	{
+		return 0xA000;
+	}
+	else if (address < 0xC000)
+	{
+		return 0xC000;
+	}
+	else if (address < 0xE000)
+	{
+		return 0xE000;
+	}
+	else if ((address >= 0xFF80) && (address < 0xFFFF))
+	{
+		return 0xFFFF;
+	}
+
+	return 0;
+}
+
+// Anything that can move PC somewhere else, or changes what happens between instructions, ends a block
+int endsBlock(BYTE opcode)
+{
+	switch (opcode)
+	{
+	case 0x10:	// STOP
+	case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:	// JR
+	case 0x76:	// HALT
+	case 0xc0: case 0xc8: case 0xc9: case 0xd0: case 0xd8: case 0xd9:	// RET, RETI
+	case 0xc2: case 0xc3: case 0xca: case 0xd2: case 0xda: case 0xe9:	// JP
+	case 0xc4: case 0xcc: case 0xcd: case 0xd4: case 0xdc:	// CALL
+	case 0xc7: case 0xcf: case 0xd7: case 0xdf: case 0xe7: case 0xef: case 0xf7: case 0xff:	// RST
+	case 0xf3: case 0xfb:	// DI, EI
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/*
+	Registers the hardware changes by itself, which only ever happens from an event or when the gpu changes mode.
+	DIV and TIMA aren't in here, they are worked out from clock and change between events.
+*/
+int isPolledRegister(WORD address)
+{
+	switch (address)
+	{
+	case 0xFF0F:	// IF
+	case 0xFF41:	// STAT
+	case 0xFF44:	// LY
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/*
+	A block is an idle loop when it ends by jumping back to its own start and everything before that only reads
+	polled registers into A and tests them. Each of those instructions writes nothing but A and F, and what it
+	writes only depends on the polled value and registers the loop never changes. Once the loop has gone round
+	once every further time round leaves exactly the same state behind, until an event or the gpu changes the register.
+*/
+int isIdleLoop(decodedBlock *block)
+{
+	decodedInstruction *last = &block->instructions[block->count - 1];
+	WORD target;
+	int i;
+
+	for (i = 0; i < block->count - 1; i++)
+	{
+		decodedInstruction *instruction = &block->instructions[i];
+
+		switch (instruction->opcode)
+		{
+		case 0x00:	// NOP
+		case 0xe6:	// AND n
+		case 0xf6:	// OR n
+		case 0xfe:	// CP n
+		case 0xa0: case 0xa1: case 0xa2: case 0xa3: case 0xa4: case 0xa5: case 0xa7:	// AND r
+		case 0xb0: case 0xb1: case 0xb2: case 0xb3: case 0xb4: case 0xb5: case 0xb7:	// OR r
+		case 0xb8: case 0xb9: case 0xba: case 0xbb: case 0xbc: case 0xbd: case 0xbf:	// CP r
+			break;
+		case 0xf0:	// LDH A,(n)
+			if (!isPolledRegister(0xFF00 | instruction->operand))
+			{
+				return 0;
+			}
+			break;
+		case 0xfa:	// LD A,(nn)
+			if (!isPolledRegister(instruction->operand))
+			{
+				return 0;
+			}
+			break;
+		case 0xcb:
+			// BIT b,r on anything but (HL)
+			if (((instruction->operand & 0xC0) != 0x40) || ((instruction->operand & 0x07) == 0x06))
+			{
+				return 0;
+			}
+			break;
+		default:
+			return 0;
+		}
+	}
+
+	switch (last->opcode)
+	{
+	case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:	// JR
+		target = (WORD)(block->end + 1 + (SIGNED_BYTE)last->operand);
+		break;
+	case 0xc2: case 0xc3: case 0xca: case 0xd2: case 0xda:	// JP
+		target = last->operand;
+		break;
+	default:
+		return 0;
+	}
+
+	return target == block->address;
+}
+
+unsigned int blockIndex(WORD address, WORD bank)
+{
+	return (address ^ (address >> 10) ^ (bank << 4)) & (BLOCK_CACHE_SIZE - 1);
+}
+
+void decodeBlock(decodedBlock *block, WORD address, WORD bank, unsigned int areaEnd)
+{
+	unsigned int pc = address;
+	unsigned int i;
+
+	block->address = address;
+	block->bank = bank;
+	block->count = 0;
+	block->cycles = 0;
+	block->runs = 0;
+	block->native = NULL;
+
+	while (block->count < MAX_BLOCK_INSTRUCTIONS)
+	{
+		BYTE opcode = readMemory((WORD)pc);
+		int length = 1 + mOpcodes[opcode].operands;
+
+		// The operands would come from a different area, let the interpreter handle it
+		if (pc + length > areaEnd)
+		{
+			break;
+		}
+
+		decodedInstruction *instruction = &block->instructions[block->count++];
+		instruction->opcode = opcode;
+		instruction->length = (BYTE)length;
+		instruction->operand = 0;
+
+		if (length > 1)
+		{
+			instruction->operand = readMemory((WORD)(pc + 1));
+		}
+		if (length > 2)
+		{
+			instruction->operand |= readMemory((WORD)(pc + 2)) << 8;
+		}
+
+		if (opcode == 0xCB)
+		{
+			instruction->cycles = ((instruction->operand & 0x07) == 0x06) ? 16 : 8;
+		}
+		else
+		{
+			instruction->cycles = mOpcodeCycles[opcode];
+		}
+
+		block->cycles += instruction->cycles;
+		pc += length;
+
+		if (endsBlock(opcode))
+		{
+			break;
+		}
+	}
+
+	block->valid = (block->count > 0);
+	block->end = (WORD)(pc - 1);
+	block->idle = block->valid && isIdleLoop(block);
+	block->versions[0] = mPageVersion[address >> 8];
+	block->versions[1] = mPageVersion[block->end >> 8];
+
+	// ROM can't be written so only code in RAM has to be watched, its pages stop taking plain stores
+	if (block->valid && (address >= 0x8000))
+	{
+		for (i = address; i < pc; i++)
+		{
+			mCodeBytes[i >> 3] |= (1 << (i & 7));
+		}
+
+		mapPage((BYTE)(address >> 8));
+		mapPage((BYTE)((pc - 1) >> 8));
+	}
+}
+
+/*
+	Returns the decoded block that starts at address, decoding it first if it isn't cached or is out of date.
+	Returns NULL when the code there can't be cached and has to be run by the interpreter.
+*/
+decodedBlock *getBlock(WORD address)
+{
+	WORD bank = blockBank(address);
+	decodedBlock *block = &mBlocks[blockIndex(address, bank)];
+
+	if (block->valid && (block->address == address) && (block->bank == bank) && isBlockCurrent(block))
+	{
+		return block;
+	}
+
+	unsigned int areaEnd = blockAreaEnd(address);
+	if (!areaEnd)
+	{
+		return NULL;
+	}
+
+	decodeBlock(block, address, bank, areaEnd);
+
+	return block->valid ? block : NULL;
+}
+
+// A block goes out of date when its bank is switched out or the RAM it was decoded from is written
+int isBlockCurrent(decodedBlock *block)
+{
+	return (block->bank == blockBank(block->address))
+		&& (block->versions[0] == mPageVersion[block->address >> 8])
+		&& (block->versions[1] == mPageVersion[block->end >> 8]);
+}
+
+// Called by writeMemory when a byte that is part of a cached block changes, or when a bank is switched
+void invalidateCode(WORD address)
+{
+	BYTE page = address >> 8;
+
+	mCodeChanges++;
+
+	// Writes to ROM only switch banks, blocks from the old bank are told apart by their key
+	if (address < 0x8000)
+	{
+		return;
+	}
+
+	mPageVersion[page]++;
+
+	// Every block on the page is now out of date so none of its bytes need watching anymore
+	memset(&mCodeBytes[page << 5], 0, 0x100 / BITS_PER_BYTE);
+	mapPage(page);
+}
+
+// Whether any byte on a page is part of a cached block
+int isCodePage(BYTE page)
+{
+	int i;
+
+	for (i = 0; i < 0x100 / BITS_PER_BYTE; i++)
+	{
+		if (mCodeBytes[(page << 5) + i])
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,167 @@
+#include "memory.h"
+#include "jit.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "context.h"
+
+THREAD_LOCAL GameBoy *gb = NULL;
+
+/*
+	Creates a powered on Game Boy with an empty cartridge and makes it the current one on this thread.
+	Returns NULL when there isn't enough memory.
+*/
+GameBoy *createGameBoy()
+{
+	GameBoy *gameBoy = (GameBoy*)calloc(1, sizeof(GameBoy));
+	if (!gameBoy)
+	{
+		return NULL;
+	}
+
+	gameBoy->rom = (BYTE*)calloc(MAX_CARTRIDGE_SIZE, SIZE_OF_BYTE);
+	if (!gameBoy->rom)
+	{
+		free(gameBoy);
+		return NULL;
+	}
+	gameBoy->ownsRom = 1;
+
+	// A build with a recompiled cartridge linked in starts with it, it falls back on its own for other cartridges
+#ifdef RECOMPILED_CARTRIDGE
+	gameBoy->engine = ENGINE_RECOMPILED;
+#else
+	gameBoy->engine = ENGINE_BLOCK_CACHE;
+#endif
+	gameBoy->idleLoopSkipping = 1;
+
+	// Compiled code is thrown away by moving to a new epoch, blocks start out with none
+	gameBoy->jitEpoch = 1;
+
+	selectGameBoy(gameBoy);
+	initializeHardware();
+
+	return gameBoy;
+}
+
+void destroyGameBoy(GameBoy *gameBoy)
+{
+	GameBoy *current = gb;
+
+	if (!gameBoy)
+	{
+		return;
+	}
+
+	gb = gameBoy;
+	freeJitCode();
+	releaseChunks();
+	gb = (current == gameBoy) ? NULL : current;
+
+	if (gameBoy->ownsRom)
+	{
+		free(gameBoy->rom);
+	}
+
+	free(gameBoy);
+}
+
+void selectGameBoy(GameBoy *gameBoy)
+{
+	gb = gameBoy;
+}
+
+/*
+	Makes the current instance run from the ROM another one loaded instead of its own copy, so a ROM only
+	takes memory once however many instances run it. The other instance has to be destroyed last.
+*/
+void shareCartridge(GameBoy *from)
+{
+	if (gb->ownsRom)
+	{
+		free(gb->rom);
+	}
+
+	gb->rom = from->rom;
+	gb->ownsRom = 0;
+	gb->header = from->header;
+
+	// Nothing decoded from the old ROM can be used anymore
+	flushBlockCache();
+	mapMemory();
+}
+
+/*
+	Makes a new instance that runs on from exactly where another one is, for searching over inputs. Memory is
+	shared copy on write in 4 KB chunks (see memory.h) and the ROM is shared like with shareCartridge, so a fork
+	costs about as much as the registers and the I/O page. The fork starts with no decoded blocks or compiled
+	code of its own. Neither instance can be running while forking, and the instance that loaded the ROM has to
+	be destroyed last. Returns NULL when there isn't enough memory.
+*/
+GameBoy *forkGameBoy(GameBoy *parent)
+{
+	GameBoy *current = gb;
+	GameBoy *child = (GameBoy*)malloc(sizeof(GameBoy));
+	int remap = 0;
+	int chunk, i;
+
+	if (!child)
+	{
+		return NULL;
+	}
+
+	// Everything before the cartridge is small and copied, the memory map in it is made again below
+	memcpy(child, parent, offsetof(GameBoy, rom));
+
+	// Most of the rest is blocks and memory the fork doesn't have yet, clearing all of it would take longer than the
+	// fork itself. The fields up to the blocks and from the jit on are cleared, of the blocks only whether they are valid
+	memset(&child->rom, 0, offsetof(GameBoy, blocks) - offsetof(GameBoy, rom));
+	for (i = 0; i < BLOCK_CACHE_SIZE; i++)
+	{
+		child->blocks[i].valid = 0;
+	}
+	memset(&child->jitEpoch, 0, offsetof(GameBoy, memory) - offsetof(GameBoy, jitEpoch));
+
+	child->rom = parent->rom;
+	child->ownsRom = 0;
+	child->header = parent->header;
+	child->mbc = parent->mbc;
+	child->engine = parent->engine;
+	child->idleLoopSkipping = parent->idleLoopSkipping;
+	child->jitEpoch = 1;
+
+	memcpy(&child->memory[0xF000], &parent->memory[0xF000], 0x1000);
+
+	selectGameBoy(parent);
+	for (chunk = 0; chunk < CHUNKS; chunk++)
+	{
+		if (IS_SHARED_CHUNK(chunk))
+		{
+			// The parent has to start catching its own writes to chunks it didn't share before
+			remap |= !mSharedChunks[chunk];
+
+			child->sharedChunks[chunk] = shareChunk(chunk);
+			if (!child->sharedChunks[chunk])
+			{
+				mapMemory();
+				destroyGameBoy(child);
+				selectGameBoy(current);
+				return NULL;
+			}
+
+			child->borrowedChunks[chunk] = 1;
+		}
+	}
+
+	if (remap)
+	{
+		mapMemory();
+	}
+
+	selectGameBoy(child);
+	mapMemory();
+
+	selectGameBoy(current);
+	return child;
+}
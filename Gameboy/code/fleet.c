@@ -0,0 +1,473 @@
+#include "fleet.h"
+#include "cartridge.h"
+#include "cpu.h"
+#include "stopwatch.h"
+#include "threads.h"
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "context.h"
+
+typedef struct
+{
+	fleet *owner;
+	int index;
+	threadHandle thread;
+
+	// Instances waiting for their next quantum. The owner pushes and pops at bottom, thieves take from top.
+	// An instance is in at most one deque at a time so each one has room for all of them
+	threadLock lock;
+	int *tasks;
+	int top;
+	int bottom;
+
+	fleetStats stats;
+} fleetWorker;
+
+struct fleet
+{
+	GameBoy **instances;
+	int instanceCount;
+	int *remaining;		// quanta left for each instance in this run
+	int *affinity;
+
+	fleetWorker *workers;
+	int workerCount;
+
+	int quantum;
+	fleetCallback callback;
+	void *user;
+
+	// Workers sleep on start until generation moves, runFleet sleeps on done until outstanding reaches 0.
+	// A worker with nothing to run or steal sleeps on work until pushes moves or the run is over
+	threadLock lock;
+	threadCondition start;
+	threadCondition done;
+	threadCondition work;
+	unsigned int generation;
+	unsigned int pushes;
+	int outstanding;
+	int shutdown;
+
+	double seconds;
+};
+
+int hostCores()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+#else
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return (cores > 0) ? (int)cores : 1;
+#endif
+}
+
+/* ------ DEQUES ------ */
+
+void pushTask(fleetWorker *worker, int instance)
+{
+	int capacity = worker->owner->instanceCount;
+
+	LOCK(&worker->lock);
+	worker->tasks[worker->bottom % capacity] = instance;
+	worker->bottom++;
+	UNLOCK(&worker->lock);
+}
+
+// The owner takes the instance it pushed last, which is usually the one it just ran. Returns -1 when empty
+int popTask(fleetWorker *worker)
+{
+	int capacity = worker->owner->instanceCount;
+	int instance = -1;
+
+	LOCK(&worker->lock);
+	if (worker->bottom != worker->top)
+	{
+		worker->bottom--;
+		instance = worker->tasks[worker->bottom % capacity];
+	}
+	UNLOCK(&worker->lock);
+
+	return instance;
+}
+
+// Thieves take the instance that has been waiting longest. Returns -1 when empty
+int stealTask(fleetWorker *victim)
+{
+	int capacity = victim->owner->instanceCount;
+	int instance = -1;
+
+	LOCK(&victim->lock);
+	if (victim->bottom != victim->top)
+	{
+		instance = victim->tasks[victim->top % capacity];
+		victim->top++;
+	}
+	UNLOCK(&victim->lock);
+
+	return instance;
+}
+
+/* ------ WORKERS ------ */
+
+int findTask(fleetWorker *worker)
+{
+	fleet *owner = worker->owner;
+	int instance = popTask(worker);
+	int i;
+
+	for (i = 1; (instance < 0) && (i < owner->workerCount); i++)
+	{
+		instance = stealTask(&owner->workers[(worker->index + i) % owner->workerCount]);
+		if (instance >= 0)
+		{
+			worker->stats.steals++;
+		}
+	}
+
+	return instance;
+}
+
+void runTasks(fleetWorker *worker)
+{
+	fleet *owner = worker->owner;
+
+	for (;;)
+	{
+		unsigned int pushes;
+		int instance;
+
+		// An instance put back after this is either found by the search below or moves pushes for the wait after it
+		LOCK(&owner->lock);
+		if (!owner->outstanding)
+		{
+			UNLOCK(&owner->lock);
+			break;
+		}
+		pushes = owner->pushes;
+		UNLOCK(&owner->lock);
+
+		instance = findTask(worker);
+
+		// Everything left is being run by other workers, sleep until one of them puts an instance back
+		if (instance < 0)
+		{
+			LOCK(&owner->lock);
+			while (owner->outstanding && (owner->pushes == pushes))
+			{
+				WAIT(&owner->work, &owner->lock);
+			}
+			UNLOCK(&owner->lock);
+			continue;
+		}
+
+		selectGameBoy(owner->instances[instance]);
+		worker->stats.cycles += cpuRun(owner->quantum);
+		worker->stats.quanta++;
+
+		if (owner->callback)
+		{
+			owner->callback(instance, owner->user);
+		}
+
+		// Only the worker running an instance touches its count, the rest is shared with the other workers
+		if (--owner->remaining[instance] > 0)
+		{
+			pushTask(worker, instance);
+
+			LOCK(&owner->lock);
+			owner->pushes++;
+			WAKE_ALL(&owner->work);
+			UNLOCK(&owner->lock);
+			continue;
+		}
+
+		LOCK(&owner->lock);
+		if (--owner->outstanding == 0)
+		{
+			WAKE_ALL(&owner->done);
+			WAKE_ALL(&owner->work);
+		}
+		UNLOCK(&owner->lock);
+	}
+
+	selectGameBoy(NULL);
+}
+
+THREAD_FUNCTION(workerThread, argument)
+{
+	fleetWorker *worker = (fleetWorker*)argument;
+	fleet *owner = worker->owner;
+	unsigned int seen = 0;
+
+	for (;;)
+	{
+		LOCK(&owner->lock);
+		while ((owner->generation == seen) && !owner->shutdown)
+		{
+			WAIT(&owner->start, &owner->lock);
+		}
+		seen = owner->generation;
+		UNLOCK(&owner->lock);
+
+		if (owner->shutdown)
+		{
+			break;
+		}
+
+		runTasks(worker);
+	}
+
+	THREAD_RETURN;
+}
+
+/* ------ FLEET ------ */
+
+fleet *createFleet(int instances, int workers, char *rom)
+{
+	GameBoy *current = gb;
+	fleet *created;
+	int i;
+
+	if (instances < 1)
+	{
+		return NULL;
+	}
+
+	created = (fleet*)calloc(1, sizeof(fleet));
+	if (!created)
+	{
+		return NULL;
+	}
+
+	created->instanceCount = instances;
+	created->workerCount = (workers > 0) ? workers : hostCores();
+	created->quantum = CYCLES_PER_FRAME;
+	created->instances = (GameBoy**)calloc(instances, sizeof(GameBoy*));
+	created->remaining = (int*)calloc(instances, sizeof(int));
+	created->affinity = (int*)malloc(instances * sizeof(int));
+	created->workers = (fleetWorker*)calloc(created->workerCount, sizeof(fleetWorker));
+
+	if (!created->instances || !created->remaining || !created->affinity || !created->workers)
+	{
+		free(created->instances);
+		free(created->remaining);
+		free(created->affinity);
+		free(created->workers);
+		free(created);
+		return NULL;
+	}
+
+	// The first instance loads the cartridge, if there is one, and the rest run from its copy
+	for (i = 0; i < instances; i++)
+	{
+		created->affinity[i] = -1;
+		created->instances[i] = createGameBoy();
+
+		if (!created->instances[i] || ((i == 0) && rom && !readROM(rom)))
+		{
+			created->instanceCount = i + 1;
+			created->workerCount = 0;
+			destroyFleet(created);
+			selectGameBoy(current);
+			return NULL;
+		}
+
+		if (i > 0)
+		{
+			shareCartridge(created->instances[0]);
+		}
+	}
+
+	// Every deque has room for all of the instances, they are all made before the first worker starts
+	for (i = 0; i < created->workerCount; i++)
+	{
+		created->workers[i].tasks = (int*)malloc(instances * sizeof(int));
+		if (!created->workers[i].tasks)
+		{
+			for (i = 0; i < created->workerCount; i++)
+			{
+				free(created->workers[i].tasks);
+			}
+
+			created->workerCount = 0;
+			destroyFleet(created);
+			selectGameBoy(current);
+			return NULL;
+		}
+	}
+
+	INITIALIZE_LOCK(&created->lock);
+	INITIALIZE_CONDITION(&created->start);
+	INITIALIZE_CONDITION(&created->done);
+	INITIALIZE_CONDITION(&created->work);
+
+	for (i = 0; i < created->workerCount; i++)
+	{
+		fleetWorker *worker = &created->workers[i];
+
+		worker->owner = created;
+		worker->index = i;
+		INITIALIZE_LOCK(&worker->lock);
+
+		START_THREAD(worker->thread, workerThread, worker);
+	}
+
+	selectGameBoy(current);
+	return created;
+}
+
+void destroyFleet(fleet *destroyed)
+{
+	int i;
+
+	if (!destroyed)
+	{
+		return;
+	}
+
+	if (destroyed->workerCount)
+	{
+		LOCK(&destroyed->lock);
+		destroyed->shutdown = 1;
+		WAKE_ALL(&destroyed->start);
+		UNLOCK(&destroyed->lock);
+
+		for (i = 0; i < destroyed->workerCount; i++)
+		{
+			fleetWorker *worker = &destroyed->workers[i];
+
+			JOIN_THREAD(worker->thread);
+			DESTROY_LOCK(&worker->lock);
+			free(worker->tasks);
+		}
+
+		DESTROY_CONDITION(&destroyed->work);
+		DESTROY_CONDITION(&destroyed->done);
+		DESTROY_CONDITION(&destroyed->start);
+		DESTROY_LOCK(&destroyed->lock);
+	}
+
+	// The first instance owns the cartridge the others share, it goes last
+	for (i = destroyed->instanceCount - 1; i >= 0; i--)
+	{
+		destroyGameBoy(destroyed->instances[i]);
+	}
+
+	free(destroyed->instances);
+	free(destroyed->remaining);
+	free(destroyed->affinity);
+	free(destroyed->workers);
+	free(destroyed);
+}
+
+GameBoy *fleetInstance(fleet *owner, int instance)
+{
+	return owner->instances[instance];
+}
+
+int fleetInstances(fleet *owner)
+{
+	return owner->instanceCount;
+}
+
+int fleetWorkers(fleet *owner)
+{
+	return owner->workerCount;
+}
+
+void setFleetQuantum(fleet *owner, int cycles)
+{
+	owner->quantum = cycles;
+}
+
+void setFleetAffinity(fleet *owner, int instance, int worker)
+{
+	owner->affinity[instance] = worker;
+}
+
+void setFleetCallback(fleet *owner, fleetCallback callback, void *user)
+{
+	owner->callback = callback;
+	owner->user = user;
+}
+
+void runFleet(fleet *owner, int quanta)
+{
+	double start = stopwatchSeconds();
+	int i;
+
+	if (quanta < 1)
+	{
+		return;
+	}
+
+	LOCK(&owner->lock);
+
+	// The workers are all asleep so the deques can be filled without anyone stealing yet
+	for (i = 0; i < owner->instanceCount; i++)
+	{
+		int worker = (owner->affinity[i] >= 0) ? owner->affinity[i] : i;
+
+		owner->remaining[i] = quanta;
+		pushTask(&owner->workers[worker % owner->workerCount], i);
+	}
+
+	owner->outstanding = owner->instanceCount;
+	owner->generation++;
+	WAKE_ALL(&owner->start);
+
+	while (owner->outstanding)
+	{
+		WAIT(&owner->done, &owner->lock);
+	}
+
+	UNLOCK(&owner->lock);
+
+	owner->seconds += stopwatchSeconds() - start;
+}
+
+fleetStats fleetWorkerStats(fleet *owner, int worker)
+{
+	return owner->workers[worker].stats;
+}
+
+fleetStats fleetTotalStats(fleet *owner)
+{
+	fleetStats total = { 0 };
+	int i;
+
+	for (i = 0; i < owner->workerCount; i++)
+	{
+		total.quanta += owner->workers[i].stats.quanta;
+		total.cycles += owner->workers[i].stats.cycles;
+		total.steals += owner->workers[i].stats.steals;
+	}
+
+	total.seconds = owner->seconds;
+
+	return total;
+}
+
+void writeFleetStats(fleet *owner, FILE *fp)
+{
+	fleetStats total = fleetTotalStats(owner);
+	double seconds = (total.seconds > 0) ? total.seconds : 1;
+	int i;
+
+	fprintf(fp, "%d instances on %d workers, quantum %d cycles\n", owner->instanceCount, owner->workerCount, owner->quantum);
+	fprintf(fp, "worker    quanta        cycles  steals\n");
+	for (i = 0; i < owner->workerCount; i++)
+	{
+		fleetStats stats = owner->workers[i].stats;
+		fprintf(fp, "%6d  %8llu  %12llu  %6llu\n", i, stats.quanta, stats.cycles, stats.steals);
+	}
+
+	fprintf(fp, "%.3f seconds, %.1f frames/s, %.1fx real time\n", total.seconds,
+		(double)total.cycles / CYCLES_PER_FRAME / seconds, (double)total.cycles / CYCLES_PER_SECOND / seconds);
+}
@@ -1,89 +1,144 @@
-#include "hardware.h"
-#include "cartridge.h"
-#include "interrupts.h"
-#include "timers.h"
-
-// Initial values at bootup for the hardware
-// Check section 3.2, Description of Registers
-void initializeHardware()
-{
-	PC.pair = 0x100;
-	SP.pair = 0xFFFE;
-	registerAF.pair = 0x01B0;
-	registerBC.pair = 0x0013;
-	registerDE.pair = 0x00D8;
-	registerHL.pair = 0x014D;
-	cpu[0xFF00] = 0xCF;
-	cpu[0xFF05] = 0x00;
-	cpu[0xFF06] = 0x00;
-	cpu[0xFF07] = 0x00;
-	cpu[0xFF10] = 0x80;
-	cpu[0xFF11] = 0xBF;
-	cpu[0xFF12] = 0xF3;
-	cpu[0xFF14] = 0xBF;
-	cpu[0xFF16] = 0x3F;
-	cpu[0xFF17] = 0x00;
-	cpu[0xFF19] = 0xBF;
-	cpu[0xFF1A] = 0x7F;
-	cpu[0xFF1B] = 0xFF;
-	cpu[0xFF1C] = 0x9F;
-	cpu[0xFF1E] = 0xBF;
-	cpu[0xFF20] = 0xFF;
-	cpu[0xFF21] = 0x00;
-	cpu[0xFF22] = 0x00;
-	cpu[0xFF23] = 0xBF;
-	cpu[0xFF24] = 0x77;
-	cpu[0xFF25] = 0xF3;
-	cpu[0xFF26] = 0xF1;
-	cpu[0xFF40] = 0x91;
-	cpu[0xFF42] = 0x00;
-	cpu[0xFF43] = 0x00;
-	cpu[0xFF45] = 0x00;
-	cpu[0xFF47] = 0xFC;
-	cpu[0xFF48] = 0xFF;
-	cpu[0xFF49] = 0xFF;
-	cpu[0xFF4A] = 0x00;
-	cpu[0xFF4B] = 0x00;
-	cpu[0xFFFF] = 0x00;
-
-	interrupt.master = 1;
-	interrupt.enable = 0;
-	interrupt.flags = 0;
-	interrupt.timer = 0xFF;
-
-	stopped = 0;
-
-	keys.keys1.a = 1;
-	keys.keys1.b = 1;
-	keys.keys1.start = 1;
-	keys.keys1.select = 1;
-
-	keys.keys2.up = 1;
-	keys.keys2.down = 1;
-	keys.keys2.left = 1;
-	keys.keys2.right = 1;
-
-	mMBC.register0 = 0;
-	mMBC.register2 = 0;
-	mMBC.register3 = 0;
-
-	mMBC.romBank = 0;
-	mMBC.ramBank = 0;	
-}
-
-void setJoypad() {
-	// TODO Document and fix this, it goes into readMemory
-	if (!(cpu[0xFF00] & 0x20))
-	{
-		cpu[0xFF00] = (BYTE)(0xC0 | keys.keys1.a | keys.keys1.b << 1 | keys.keys1.select << 2 | keys.keys1.start << 3 | 0x10);
-	}
-	else if (!(cpu[0xFF00] & 0x10))
-	{
-		cpu[0xFF00] = (BYTE)(0xC0 | keys.keys2.right | keys.keys2.left << 1 | keys.keys2.up << 2 | keys.keys2.down << 3 | 0x20);
-	}
-	else if (!(cpu[0xFF00] & 0x30))
-	{
-		cpu[0xFF00] = 0xFF;
-	}
-	else cpu[0xFF00] = 0xCF;
-}
+#include "hardware.h"
+#include "cartridge.h"
+#include "interrupts.h"
+#include "timers.h"
+#include "gpu.h"
+#include "scheduler.h"
+#include "blockcache.h"
+#include "memory.h"
+#include "lazyflags.h"
+#include "alutables.h"
+#include "context.h"
+
+// Initial values at bootup for the hardware
+// Check section 3.2, Description of Registers
+void initializeHardware()
+{
+	PC.pair = 0x100;
+	SP.pair = 0xFFFE;
+	registerAF.pair = 0x01B0;
+	registerBC.pair = 0x0013;
+	registerDE.pair = 0x00D8;
+	registerHL.pair = 0x014D;
+	mLazyFlags.operation = LAZY_NONE;
+#ifdef TABLE_ALU
+	initializeAluTables();
+#endif
+	cpu[0xFF00] = 0xCF;
+	cpu[0xFF06] = 0x00;
+	cpu[0xFF07] = 0x00;
+	cpu[0xFF10] = 0x80;
+	cpu[0xFF11] = 0xBF;
+	cpu[0xFF12] = 0xF3;
+	cpu[0xFF14] = 0xBF;
+	cpu[0xFF16] = 0x3F;
+	cpu[0xFF17] = 0x00;
+	cpu[0xFF19] = 0xBF;
+	cpu[0xFF1A] = 0x7F;
+	cpu[0xFF1B] = 0xFF;
+	cpu[0xFF1C] = 0x9F;
+	cpu[0xFF1E] = 0xBF;
+	cpu[0xFF20] = 0xFF;
+	cpu[0xFF21] = 0x00;
+	cpu[0xFF22] = 0x00;
+	cpu[0xFF23] = 0xBF;
+	cpu[0xFF24] = 0x77;
+	cpu[0xFF25] = 0xF3;
+	cpu[0xFF26] = 0xF1;
+	cpu[0xFF40] = 0x91;
+	cpu[0xFF42] = 0x00;
+	cpu[0xFF43] = 0x00;
+	cpu[0xFF45] = 0x00;
+	cpu[0xFF47] = 0xFC;
+	cpu[0xFF48] = 0xFF;
+	cpu[0xFF49] = 0xFF;
+	cpu[0xFF4A] = 0x00;
+	cpu[0xFF4B] = 0x00;
+
+	interrupt.master = 1;
+	interrupt.enable = 0;
+	interrupt.flags = 0;
+	interrupt.pending = 0;
+
+	halt = 0;
+	stopped = 0;
+
+	keys.keys1.a = 1;
+	keys.keys1.b = 1;
+	keys.keys1.start = 1;
+	keys.keys1.select = 1;
+
+	keys.keys2.up = 1;
+	keys.keys2.down = 1;
+	keys.keys2.left = 1;
+	keys.keys2.right = 1;
+
+	mMBC.register0 = 0;
+	mMBC.register2 = 0;
+	mMBC.register3 = 0;
+
+	mMBC.romBank = 0;
+	mMBC.ramBank = 0;	
+
+	flushBlockCache();
+	mapMemory();
+
+	// The gpu and timers start scheduling their events from power on
+	clock = 0;
+	initializeScheduler();
+	initializeGpu();
+	initializeTimers();
+}
+
+/*
+	The game picks whether it wants to see the buttons or the directions by clearing bit 5 or bit 4 of FF00,
+	the keys are only looked at when it reads the register back.
+*/
+void writeJoypad(BYTE data)
+{
+	cpu[0xFF00] = data;
+}
+
+BYTE readJoypad()
+{
+	if (!(cpu[0xFF00] & 0x20))
+	{
+		return (BYTE)(0xC0 | keys.keys1.a | keys.keys1.b << 1 | keys.keys1.select << 2 | keys.keys1.start << 3 | 0x10);
+	}
+	else if (!(cpu[0xFF00] & 0x10))
+	{
+		return (BYTE)(0xC0 | keys.keys2.right | keys.keys2.left << 1 | keys.keys2.up << 2 | keys.keys2.down << 3 | 0x20);
+	}
+
+	return 0xCF;
+}
+
+/*
+	All input goes through here, so it can be recorded and played back. Pressing or letting go of a button wakes
+	a stopped cpu, the same buttons held again change nothing.
+*/
+void setJoypad(BYTE pressed)
+{
+	BYTE changed = pressed ^ getJoypad();
+
+	keys.keys1.a = !(pressed & JOYPAD_A);
+	keys.keys1.b = !(pressed & JOYPAD_B);
+	keys.keys1.select = !(pressed & JOYPAD_SELECT);
+	keys.keys1.start = !(pressed & JOYPAD_START);
+
+	keys.keys2.right = !(pressed & JOYPAD_RIGHT);
+	keys.keys2.left = !(pressed & JOYPAD_LEFT);
+	keys.keys2.up = !(pressed & JOYPAD_UP);
+	keys.keys2.down = !(pressed & JOYPAD_DOWN);
+
+	if (changed)
+	{
+		stopped = 0;
+	}
+}
+
+BYTE getJoypad()
+{
+	return (BYTE)(~(keys.keys1.a | keys.keys1.b << 1 | keys.keys1.select << 2 | keys.keys1.start << 3
+		| keys.keys2.right << 4 | keys.keys2.left << 5 | keys.keys2.up << 6 | keys.keys2.down << 7));
+}
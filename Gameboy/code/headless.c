@@ -0,0 +1,202 @@
+// The front end for machines without a screen. It runs a cartridge or replays a movie as fast as the core
+// goes and reports how fast that was, runs the opcode tests and the benchmarks and translates cartridges to C
+
+#include "cartridge.h"
+#include "cpu.h"
+#include "movie.h"
+#include "platform.h"
+#include "recompiler.h"
+#include "stopwatch.h"
+#include "test_cases.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+
+#define DEFAULT_FRAMES 3600
+
+void countFrame(void *user)
+{
+	(*(int*)user)++;
+}
+
+void printLog(const char *line, void *user)
+{
+	fputs(line, stderr);
+}
+
+void printUsage()
+{
+	fprintf(stderr, "usage: headless rom [frames] [-engine n] [-movie file] [-log]\n");
+	fprintf(stderr, "       headless -test\n");
+	fprintf(stderr, "       headless -bench rom\n");
+	fprintf(stderr, "       headless -recompile rom file\n");
+	fprintf(stderr, "       headless -testrom file\n");
+	fprintf(stderr, "  frames       frames to run, %d unless given\n", DEFAULT_FRAMES);
+	fprintf(stderr, "  -engine n    0 interpreter, 1 block cache, 2 jit, 3 recompiled in a build with a cartridge linked in\n");
+	fprintf(stderr, "  -movie file  replay a movie instead, fails when it doesn't end where it was recorded\n");
+	fprintf(stderr, "  -log         debug logs to stderr\n");
+	fprintf(stderr, "  -test        run the opcode tests\n");
+	fprintf(stderr, "  -bench rom   run the benchmarks on the cartridge, each writes BENCHMARK_*.txt here\n");
+	fprintf(stderr, "  -recompile   translate the cartridge to a C file to build in with RECOMPILED_CARTRIDGE\n");
+	fprintf(stderr, "  -testrom     write the cartridge the tests run to a file, for a recompiled build to test\n");
+}
+
+int main(int argc, char **argv)
+{
+	char *rom = NULL;
+	char *moviePath = NULL;
+	int frames = DEFAULT_FRAMES;
+	int engine = -1;
+	int logging = 0;
+	int drawn = 0;
+	int matched = 1;
+	CYCLES cycles = 0;
+	double start, seconds;
+	platform headless;
+	int i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-engine") && (i + 1 < argc))
+		{
+			engine = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-movie") && (i + 1 < argc))
+		{
+			moviePath = argv[++i];
+		}
+		else if (!strcmp(argv[i], "-log"))
+		{
+			logging = 1;
+		}
+		else if (!strcmp(argv[i], "-test"))
+		{
+			// The tests assert, a failure ends the program before this returns
+			if (!createGameBoy())
+			{
+				return 1;
+			}
+
+			TEST_OPCODES();
+			printf("opcode tests passed\n");
+			return 0;
+		}
+		else if (!strcmp(argv[i], "-bench") && (i + 1 < argc))
+		{
+			if (!createGameBoy() || !RUN_BENCHMARKS(argv[i + 1]))
+			{
+				fprintf(stderr, "can't read %s\n", argv[i + 1]);
+				return 1;
+			}
+
+			printf("benchmarks written to BENCHMARK_*.txt\n");
+			return 0;
+		}
+		else if (!strcmp(argv[i], "-recompile") && (i + 2 < argc))
+		{
+			if (!createGameBoy() || !readROM(argv[i + 1]))
+			{
+				fprintf(stderr, "can't read %s\n", argv[i + 1]);
+				return 1;
+			}
+
+			if (!RECOMPILE_CARTRIDGE(argv[i + 2]))
+			{
+				fprintf(stderr, "can't write %s\n", argv[i + 2]);
+				return 1;
+			}
+
+			return 0;
+		}
+		else if (!strcmp(argv[i], "-testrom") && (i + 1 < argc))
+		{
+			if (!WRITE_TEST_CARTRIDGE(argv[i + 1]))
+			{
+				fprintf(stderr, "can't write %s\n", argv[i + 1]);
+				return 1;
+			}
+
+			return 0;
+		}
+		else if (!rom)
+		{
+			rom = argv[i];
+		}
+		else
+		{
+			frames = atoi(argv[i]);
+		}
+	}
+
+	if (!rom || (frames <= 0) || (engine >= ENGINE_COUNT))
+	{
+		printUsage();
+		return 1;
+	}
+
+	memset(&headless, 0, sizeof(headless));
+	headless.frame = countFrame;
+	headless.log = logging ? printLog : NULL;
+	headless.user = &drawn;
+	setPlatform(&headless);
+
+	if (!createGameBoy() || !readROM(rom))
+	{
+		fprintf(stderr, "can't read %s\n", rom);
+		return 1;
+	}
+
+	if (engine >= 0)
+	{
+		mEngine = (cpuEngine)engine;
+	}
+
+	start = stopwatchSeconds();
+	if (moviePath)
+	{
+		movie *replayed = readMovie(moviePath);
+		if (!replayed)
+		{
+			fprintf(stderr, "can't read %s\n", moviePath);
+			return 1;
+		}
+
+		if (!startReplay(replayed))
+		{
+			fprintf(stderr, "%s was recorded from another cartridge\n", moviePath);
+			return 1;
+		}
+
+		while ((i = replayMovie(replayed, CYCLES_PER_SECOND)))
+		{
+			cycles += i;
+		}
+
+		matched = replayMatches(replayed);
+		destroyMovie(replayed);
+	}
+	else
+	{
+		for (i = 0; i < frames; i++)
+		{
+			cycles += runFrame();
+		}
+	}
+	seconds = stopwatchSeconds() - start;
+	if (seconds <= 0)
+	{
+		seconds = 1;
+	}
+
+	printf("%d frames drawn, %.3f seconds, %.1f frames/s, %.1fx real time\n", drawn, seconds,
+		(double)cycles / CYCLES_PER_FRAME / seconds, (double)cycles / CYCLES_PER_SECOND / seconds);
+
+	if (moviePath)
+	{
+		printf(matched ? "replay matches the recording\n" : "replay doesn't match the recording\n");
+	}
+
+	return !matched;
+}
@@ -0,0 +1,76 @@
+#ifndef ALUTABLES_H
+#define ALUTABLES_H
+
+#include "hardware.h"
+
+/*
+	Building with TABLE_ALU looks the flags (and for the shifts and DAA the result too) up in tables
+	instead of working them out with branches. The 256 entry INC/DEC tables, the shift tables and the DAA
+	table are built by the compiler, the ADD and SUB flag tables are 64k each and are filled in the first
+	time an instance powers on.
+*/
+
+// Flags of INC and DEC for every value, C isn't in them since both keep it
+extern const BYTE mIncFlags[0x100];
+extern const BYTE mDecFlags[0x100];
+
+// Flags of ADD and SUB (CP too) by A << 8 | operand. ADC and SBC add the carry to the operand first, like the helpers do
+extern BYTE mAddFlags[0x10000];
+extern BYTE mSubFlags[0x10000];
+
+// CB shifts in the order they are encoded in, each by carry << 8 | value. The entries are result | flags << 8
+#define SHIFT_RLC	0
+#define SHIFT_RRC	1
+#define SHIFT_RL	2
+#define SHIFT_RR	3
+#define SHIFT_SLA	4
+#define SHIFT_SRA	5
+#define SHIFT_SWAP	6
+#define SHIFT_SRL	7
+
+extern const WORD mShiftTable[8][0x200];
+
+// DAA by N H C << 8 | A, which is just the flags shifted down. The entries are result | flags to set << 8
+extern const WORD mDaaTable[0x800];
+
+// The shifts don't have a lazy version so they are picked here
+#ifdef TABLE_ALU
+#define ALU_RLC		tableRLC
+#define ALU_RRC		tableRRC
+#define ALU_RL		tableRL
+#define ALU_RR		tableRR
+#define ALU_SLA		tableSLA
+#define ALU_SRA		tableSRA
+#define ALU_SWAP	tableSWAP
+#define ALU_SRL		tableSRL
+#else
+#define ALU_RLC		RLC
+#define ALU_RRC		RRC
+#define ALU_RL		RL
+#define ALU_RR		RR
+#define ALU_SLA		SLA
+#define ALU_SRA		SRA
+#define ALU_SWAP	SWAP
+#define ALU_SRL		SRL
+#endif
+
+void initializeAluTables(void);
+
+BYTE tableINC(BYTE);
+BYTE tableDEC(BYTE);
+void tableADD(BYTE);
+void tableADC(BYTE);
+void tableSUB(BYTE);
+void tableSBC(BYTE);
+void tableCP(BYTE);
+BYTE tableRLC(BYTE);
+BYTE tableRRC(BYTE);
+BYTE tableRL(BYTE);
+BYTE tableRR(BYTE);
+BYTE tableSLA(BYTE);
+BYTE tableSRA(BYTE);
+BYTE tableSWAP(BYTE);
+BYTE tableSRL(BYTE);
+void tableDAA(void);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "hardware.h"
+
+/*
+	Experimental engine that runs many instances of one cartridge in lock-step. The registers of every
+	lane are kept in structure of arrays layout, and while the lanes are at the same PC on the same cycle
+	an instruction that only works on registers is run for all of them at once with SIMD. Anything that
+	touches memory or the hardware is run lane by lane with the interpreter. A lane that ends up somewhere
+	else leaves the group and finishes the run on its own, the group is formed again at the start of
+	every run from the lanes that agree the most.
+*/
+typedef struct batch batch;
+
+typedef struct
+{
+	unsigned long long runs;			// calls to runBatch
+	unsigned long long vectorSteps;		// instructions run once for the whole group
+	unsigned long long scalarSteps;		// instructions the group had to run lane by lane
+	unsigned long long groupedLanes;	// lanes that started a run in the group, summed over the runs
+	unsigned long long divergences;		// lanes that left the group during a run
+} batchStats;
+
+// Returns NULL when the ROM can't be read, every lane runs from the same copy of it. Without a ROM the cartridge
+// is left empty for the caller to fill in through the first lane before running
+batch *createBatch(int, char *);
+void destroyBatch(batch *);
+
+struct GameBoy *batchInstance(batch *, int);
+int batchLanes(batch *);
+
+// Runs every lane for at least the given number of cycles, like cpuRun does for one instance
+void runBatch(batch *, int);
+
+batchStats getBatchStats(batch *);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include "hardware.h"
+
+// A block stops at the first jump, call, return or anything that changes interrupts or halts the cpu,
+// or once it has this many instructions
+#define MAX_BLOCK_INSTRUCTIONS 16
+
+// Number of blocks kept at once, must be a power of 2
+#define BLOCK_CACHE_SIZE 1024
+
+// An instruction that has already been fetched and decoded. The opcode selects the handler in executeOpcode
+typedef struct
+{
+	BYTE opcode;
+	BYTE length;	// opcode plus operand bytes
+	BYTE cycles;	// cycles the handler takes, for conditional jumps and calls when the branch isn't taken
+	WORD operand;
+} decodedInstruction;
+
+typedef struct
+{
+	WORD address;		// PC of the first instruction
+	WORD end;			// last byte of the last instruction
+	WORD bank;			// ROM bank for 0x4000 - 0x7FFF, RAM bank for 0xA000 - 0xBFFF and 0 everywhere else
+	BYTE valid;
+	BYTE count;
+	BYTE idle;			// only polls hardware registers and jumps back to its start, see isIdleLoop
+	unsigned int versions[2];	// versions of the pages the block covers when it was decoded
+	int cycles;					// cycles to run the whole block when the last instruction doesn't branch
+	unsigned int runs;			// times the block was run, the jit compiles it once it gets hot
+	void *native;				// compiled code, only usable while nativeEpoch matches the jit's
+	unsigned int nativeEpoch;
+	decodedInstruction instructions[MAX_BLOCK_INSTRUCTIONS];
+} decodedBlock;
+
+// Cycles each handler takes, see blockcache.c
+extern BYTE mOpcodeCycles[256];
+
+#define IS_CODE_BYTE(address) (mCodeBytes[(address) >> 3] & (1 << ((address) & 7)))
+
+void flushBlockCache(void);
+WORD blockBank(WORD);
+int endsBlock(BYTE);
+int isPolledRegister(WORD);
+decodedBlock *getBlock(WORD);
+int isBlockCurrent(decodedBlock *);
+void invalidateCode(WORD);
+int isCodePage(BYTE);
+
+#endif
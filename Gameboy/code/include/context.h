@@ -0,0 +1,182 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "hardware.h"
+#include "cartridge.h"
+#include "interrupts.h"
+#include "lazyflags.h"
+#include "timers.h"
+#include "scheduler.h"
+#include "blockcache.h"
+#include "cpu.h"
+#include "memory.h"
+
+/*
+	Everything that makes up one emulated Game Boy. Any number of them can live in one process, the code
+	works on whichever is current on the calling thread, see selectGameBoy. The ROM can be shared between
+	instances, everything else belongs to one of them.
+*/
+typedef struct GameBoy
+{
+	// What the cpu touches on every instruction comes first so it fits in as few cache lines as possible
+	Register af, bc, de, hl, sp, pc;
+	interruptStruct interrupts;
+	CYCLES cycles;			// clock, cycles run since power on. It is never reset, hardware schedules its events against it
+	CYCLES nextEvent;		// earliest deadline of all scheduled events, the cpu only calls into the scheduler once clock reaches it
+	CYCLES jitTarget;
+	unsigned int codeChanges;	// goes up on every write that could change the code at some address, bank switches included
+	int halted;
+	int isStopped;
+	lazyFlagsState lazyFlags;
+
+	// Memory behind each 256 byte page, NULL in writePages when writes to the page need more than a store
+	BYTE *readPages[0x100];
+	BYTE *writePages[0x100];
+
+	// Hardware
+	event events[EVENT_COUNT];
+	eventType eventHeap[EVENT_COUNT];		// eventHeap[0] is always the next event due
+	int eventHeapSize;
+	int eventHeapPosition[EVENT_COUNT];		// where each event type is in the heap, -1 when it isn't scheduled
+	int gpuMode;
+	BYTE gpuLine;
+	CYCLES gpuModeEnd;
+	float linePixels[SCREEN_WIDTH * 3];
+	timerStruct timers;
+	Keys joypad;
+
+	// Cartridge, rom is MAX_CARTRIDGE_SIZE bytes and only freed with the instance when ownsRom is set
+	BYTE *rom;
+	int ownsRom;
+	cartridgeHeader header;
+	memoryBankController mbc;
+
+	// Engines
+	cpuEngine engine;
+
+	// Loops that only poll hardware registers are skipped up to the next event by the block engines. It can be
+	// turned off when testing accuracy, idleLoopCycles counts the cycles that were skipped
+	int idleLoopSkipping;
+	unsigned long long idleLoopCycles;
+
+	/*
+		Code running from RAM can be rewritten, so each 256 byte page has a version that goes up whenever
+		a byte that was decoded into a block is written. Blocks remember the versions they were decoded
+		with and are thrown away when they no longer match.
+	*/
+	unsigned int pageVersion[0x100];
+
+	// One bit per address, set for every byte in RAM that is part of a cached block
+	BYTE codeBytes[0x10000 / BITS_PER_BYTE];
+	decodedBlock blocks[BLOCK_CACHE_SIZE];
+
+	// Compiled code is thrown away by moving to a new epoch, blocks from older epochs are compiled again.
+	// The code refers to this instance's state directly so every instance compiles its own
+	unsigned int jitEpoch;
+	BYTE *jitCode;
+	unsigned int jitUsed;
+	BYTE *jitEmit;		// where the next byte of native code goes while compiling
+	struct jitScratch *jitScratch;	// the states runVerified compares, only allocated once the instance verifies a block
+	int jitMismatches;
+
+	// Chunks of memory and extRAM shared with other instances after a fork, see memory.h. A borrowed chunk
+	// is only in the shared copy, the rest are in memory and extRAM as well
+	sharedChunk *sharedChunks[CHUNKS];
+	BYTE borrowedChunks[CHUNKS];
+
+	// Pages of memory and extRAM written since the dirty pages were last cleared, only kept while trackingDirtyPages is set
+	int trackingDirtyPages;
+	BYTE dirtyPages[DIRTY_PAGES / BITS_PER_BYTE];
+
+	// The cpu memory map looks like :
+	//
+	//--------------------------- FFFF
+	// I/O ports + internal RAM
+	//--------------------------- FF00
+	// Internal RAM
+	//--------------------------- C000
+	// 8kB switchable RAM bank
+	//--------------------------- A000
+	// 16kB VRAM
+	//--------------------------- 8000
+	// 16kB switchable ROM bank
+	//--------------------------- 4000
+	// 16kB ROM bank #0
+	//--------------------------- 0000
+	//
+	// So total memory for the CPU is 0x10000 values
+	BYTE memory[0x10000];
+	BYTE extRAM[MAX_EXT_RAM_SIZE];
+} GameBoy;
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+// The instance the emulator is working on, every thread has its own
+extern THREAD_LOCAL GameBoy *gb;
+
+GameBoy *createGameBoy(void);
+void destroyGameBoy(GameBoy *);
+void selectGameBoy(GameBoy *);
+void shareCartridge(GameBoy *);
+GameBoy *forkGameBoy(GameBoy *);
+
+// The rest of the code uses the names the state had before it was moved into the instance. These are macros,
+// so this header goes after any system header that could use one of the names, clock from time.h for one
+#define registerAF			(gb->af)
+#define registerBC			(gb->bc)
+#define registerDE			(gb->de)
+#define registerHL			(gb->hl)
+#define SP					(gb->sp)
+#define PC					(gb->pc)
+#define interrupt			(gb->interrupts)
+#define clock				(gb->cycles)
+#define mNextEvent			(gb->nextEvent)
+#define mJitTarget			(gb->jitTarget)
+#define mCodeChanges		(gb->codeChanges)
+#define halt				(gb->halted)
+#define stopped				(gb->isStopped)
+#define mLazyFlags			(gb->lazyFlags)
+#define mReadPages			(gb->readPages)
+#define mWritePages			(gb->writePages)
+
+#define mEvents				(gb->events)
+#define mHeap				(gb->eventHeap)
+#define mHeapSize			(gb->eventHeapSize)
+#define mHeapPosition		(gb->eventHeapPosition)
+#define mMode				(gb->gpuMode)
+#define mLine				(gb->gpuLine)
+#define mGpuModeEnd			(gb->gpuModeEnd)
+#define mCurrentLinePixels	(gb->linePixels)
+#define mTimer				(gb->timers)
+#define keys				(gb->joypad)
+
+#define mCartridge			(gb->rom)
+#define mCartridgeHeader	(gb->header)
+#define mMBC				(gb->mbc)
+
+#define mEngine				(gb->engine)
+#define mIdleLoopSkipping	(gb->idleLoopSkipping)
+#define mIdleLoopCycles		(gb->idleLoopCycles)
+#define mPageVersion		(gb->pageVersion)
+#define mCodeBytes			(gb->codeBytes)
+#define mBlocks				(gb->blocks)
+#define mJitEpoch			(gb->jitEpoch)
+#define mJitCode			(gb->jitCode)
+#define mJitUsed			(gb->jitUsed)
+#define mEmit				(gb->jitEmit)
+#define mJitScratch			(gb->jitScratch)
+#define mJitMismatches		(gb->jitMismatches)
+
+#define mSharedChunks		(gb->sharedChunks)
+#define mBorrowedChunks		(gb->borrowedChunks)
+#define mTrackDirtyPages	(gb->trackingDirtyPages)
+#define mDirtyPages			(gb->dirtyPages)
+
+#define cpu					(gb->memory)
+#define mExtRAM				(gb->extRAM)
+
+#endif
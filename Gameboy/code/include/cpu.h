@@ -1,12 +1,36 @@
-#ifndef CPU_H
-#define CPU_H
-
-#include "opcodes.h"
-
-// There are 256 opcodes for GB
-struct opcode mOpcodes[256];
-
-void cpuStep(void);
-
-void DEBUG_CARTRIDGE(void);
-#endif
+#ifndef CPU_H
+#define CPU_H
+
+#include "opcodes.h"
+#include "blockcache.h"
+
+// There are 256 opcodes for GB. Execution goes through executeOpcode, the table is kept for
+// the operand counts and for tooling that needs to look up an opcode by its handler
+extern struct opcode mOpcodes[256];
+
+// Instructions can be run one at a time by the interpreter or from blocks that were already decoded.
+// Both give the same results, the engine can be switched at any time
+typedef enum
+{
+	ENGINE_INTERPRETER,
+	ENGINE_BLOCK_CACHE,
+	ENGINE_JIT,
+#ifdef RECOMPILED_CARTRIDGE
+	ENGINE_RECOMPILED,
+#endif
+	ENGINE_COUNT
+} cpuEngine;
+
+extern int PRINT_LOGS;
+
+void cpuStep(void);
+void afterInstruction(void);
+void stepInstruction(void);
+void runDecodedBlock(decodedBlock *, CYCLES);
+void skipIdleLoop(decodedBlock *, CYCLES, CYCLES, CYCLES);
+void runBlock(CYCLES);
+void skipHalt(CYCLES);
+int cpuRun(int);
+
+void DEBUG_CARTRIDGE(void);
+#endif
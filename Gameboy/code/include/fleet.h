@@ -0,0 +1,51 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include "hardware.h"
+#include <stdio.h>
+
+/*
+	A fleet runs many independent instances of one cartridge on a pool of worker threads. The work is
+	split into tasks of one quantum, running one instance for quantum cycles. Every worker has its own
+	deque of tasks, it takes from the bottom of its own and steals from the top of the others once it
+	runs dry, and sleeps while there is nothing left to steal. An instance stays with the worker that
+	ran it last unless someone steals it, so it keeps running on a core that has its state in cache.
+*/
+typedef struct fleet fleet;
+
+// Called on a worker thread after every quantum an instance runs, with that instance selected.
+// Callbacks for different instances can run at the same time
+typedef void(*fleetCallback)(int, void *);
+
+typedef struct
+{
+	unsigned long long quanta;	// tasks run
+	unsigned long long cycles;	// cycles emulated
+	unsigned long long steals;	// tasks taken from another worker's deque
+	double seconds;				// wall clock time spent in runFleet, only kept in the totals
+} fleetStats;
+
+// Workers can be 0 to start one for every core of the host. Returns NULL when the ROM can't be read. Without a ROM
+// the cartridge is left empty for the caller to fill in through the first instance before running
+fleet *createFleet(int, int, char *);
+void destroyFleet(fleet *);
+
+struct GameBoy *fleetInstance(fleet *, int);
+int fleetInstances(fleet *);
+int fleetWorkers(fleet *);
+
+// Cycles each task runs, a frame unless set otherwise
+void setFleetQuantum(fleet *, int);
+
+// Starts an instance on the given worker's deque every run, -1 spreads instances over the workers
+void setFleetAffinity(fleet *, int, int);
+void setFleetCallback(fleet *, fleetCallback, void *);
+
+// Runs every instance for the given number of quanta and returns once all of them are done
+void runFleet(fleet *, int);
+
+fleetStats fleetWorkerStats(fleet *, int);
+fleetStats fleetTotalStats(fleet *);
+void writeFleetStats(fleet *, FILE *);
+
+#endif
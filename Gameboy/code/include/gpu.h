@@ -1,20 +1,43 @@
-#ifndef GPU_H
-#define GPU_H
-
-#ifndef GL_H
-#define GL_H
-#include <GL/gl.h>
-#endif
-
-void gpuStep(void);
-void cleanLine(void);
-void processLine(void);
-void renderScanline(void);
-void fillOAMFolder(char foldername[]);
-void ExportScreen(char foldername[]);
-void DEBUG_GPU(void);
-void TOGGLE_WINDOW_LAYER(void);
-void TOGGLE_BG_LAYER(void);
-void TOGGLE_SPRITE_LAYER(void);
-void RECORD_GPU_LOGS(void);
-#endif
+#ifndef GPU_H
+#define GPU_H
+
+#include "hardware.h"
+
+/*
+	The gpu runs behind the cpu and only catches up when something could tell: a write to VRAM, OAM or
+	one of the LCD registers, a read of LY or STAT, or the event for the next interrupt it raises.
+	mGpuModeEnd is the cycle the mode it is in ends.
+*/
+#define GPU_CATCH_UP() do { if (clock >= mGpuModeEnd) gpuCatchUp(); } while (0)
+
+void initializeGpu(void);
+void gpuCatchUp(void);
+void gpuEvent(CYCLES);
+void scheduleGpu(void);
+
+// I/O handlers for 0xFF40 - 0xFF4B
+BYTE readScanline(void);
+void writeScanline(BYTE);
+BYTE readLcdStatus(void);
+void writeLcdStatus(BYTE);
+void writeLcdControl(BYTE);
+void writeScrollY(BYTE);
+void writeScrollX(BYTE);
+void writeLyCompare(BYTE);
+void writeBackgroundPalette(BYTE);
+void writeObjectPalette0(BYTE);
+void writeObjectPalette1(BYTE);
+void writeWindowY(BYTE);
+void writeWindowX(BYTE);
+
+void cleanLine(void);
+void processLine(void);
+void renderScanline(void);
+void fillOAMFolder(char foldername[]);
+void ExportScreen(char foldername[]);
+void DEBUG_GPU(void);
+void TOGGLE_WINDOW_LAYER(void);
+void TOGGLE_BG_LAYER(void);
+void TOGGLE_SPRITE_LAYER(void);
+void RECORD_GPU_LOGS(void);
+#endif
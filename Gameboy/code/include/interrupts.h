@@ -1,22 +1,38 @@
-#define INTERRUPTS_VBLANK   (1 << 0)
-#define INTERRUPTS_LCDSTAT  (1 << 1)
-#define INTERRUPTS_TIMER    (1 << 2)
-#define INTERRUPTS_SERIAL   (1 << 3)
-#define INTERRUPTS_JOYPAD   (1 << 4)
-
-typedef struct {
-	unsigned char master;
-	unsigned char enable;
-	unsigned char flags;
-	unsigned char timer;
-} interruptStruct;
-
-interruptStruct interrupt;
-
-void interruptStep(void);
-
-void vblank(void);
-void lcdStat(void);
-void timer(void);
-void serial(void);
-void joypad(void);
+#ifndef INTERRUPTS_H
+#define INTERRUPTS_H
+
+#include "hardware.h"
+
+#define INTERRUPTS_VBLANK   (1 << 0)
+#define INTERRUPTS_LCDSTAT  (1 << 1)
+#define INTERRUPTS_TIMER    (1 << 2)
+#define INTERRUPTS_SERIAL   (1 << 3)
+#define INTERRUPTS_JOYPAD   (1 << 4)
+#define INTERRUPTS_ALL      0x1F
+
+/*
+	pending is enable & flags while master is set and 0 otherwise. It is worked out again by updateInterrupts
+	every time one of the others changes, and while it isn't 0 the scheduler has an event due to take the
+	interrupt, so between two instructions nothing has to look at the interrupts at all. An enabled flag ends a
+	halt even while master isn't set, updateInterrupts takes care of that when it goes up.
+*/
+typedef struct {
+	unsigned char master;
+	unsigned char enable;
+	unsigned char flags;
+	unsigned char pending;
+} interruptStruct;
+
+void updateInterrupts(void);
+void requestInterrupt(BYTE);
+void enableInterrupts(void);
+void disableInterrupts(void);
+void interruptStep(CYCLES);
+
+void vblank(void);
+void lcdStat(void);
+void timer(void);
+void serial(void);
+void joypad(void);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef IO_H
+#define IO_H
+
+#include "hardware.h"
+
+/*
+	The I/O ports at 0xFF00 - 0xFF7F each have a slot for a read and a write handler. A register without a
+	handler is a plain byte in cpu[], one with a handler is owned by it and cpu[] isn't looked at. IE at 0xFFFF
+	only lives in the interrupt struct.
+*/
+#define IO_PORTS 0x80
+
+typedef BYTE(*ioReadHandler)(void);
+typedef void(*ioWriteHandler)(BYTE);
+
+extern const ioReadHandler mIORead[IO_PORTS];
+extern const ioWriteHandler mIOWrite[IO_PORTS];
+
+// Everything on the 0xFF00 page goes through these, HRAM included
+BYTE readIO(WORD);
+void writeIO(WORD, BYTE);
+
+#endif
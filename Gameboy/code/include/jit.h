@@ -0,0 +1,26 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "hardware.h"
+#include "blockcache.h"
+
+// The jit only knows how to write x86-64, on anything else blocks keep running from the block cache
+#if defined(_M_X64) || defined(__x86_64__)
+#define JIT_SUPPORTED
+#endif
+
+// A decoded block is compiled once it has been run this many times
+#define JIT_THRESHOLD 16
+
+// Native code goes into one buffer, once it is full everything is thrown away and compiled again
+#define JIT_CODE_SIZE (4 * 1024 * 1024)
+
+// Runs every compiled block a second time with the interpreter and compares the results. Mismatches are
+// logged, counted in the instance's mJitMismatches and the block goes back to the interpreter
+extern int mJitVerify;
+
+void runJit(CYCLES);
+void flushJit(void);
+void freeJitCode(void);
+
+#endif
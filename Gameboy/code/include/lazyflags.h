@@ -0,0 +1,92 @@
+#ifndef LAZYFLAGS_H
+#define LAZYFLAGS_H
+
+#include "hardware.h"
+
+/*
+	Most flags the ALU sets are overwritten by the next ALU instruction before anything looks at them.
+	Building with LAZY_FLAGS makes the ALU helpers only remember what they did, and F is worked out
+	from that the first time something reads it or changes single flags. Z and C are the ones read by
+	conditional jumps, they can be answered without working out the rest.
+*/
+typedef enum
+{
+	LAZY_NONE,		// F is up to date
+	LAZY_ADD,		// ADD and ADC
+	LAZY_SUB,		// SUB, SBC and CP
+	LAZY_AND,
+	LAZY_OR,		// OR and XOR
+	LAZY_INC,
+	LAZY_DEC,
+	LAZY_ADD_16
+} lazyOperation;
+
+typedef struct
+{
+	lazyOperation operation;
+	WORD a;			// first operand, A or HL
+	WORD b;			// second operand
+	BYTE result;	// result of 8 bit operations
+	BYTE carry;		// C from before INC and DEC, which don't change it
+	BYTE zero;		// Z from before ADD_16, which doesn't change it
+} lazyFlagsState;
+
+// The handlers call the ALU through these so any version can be built, LAZY_FLAGS wins over TABLE_ALU
+#ifdef LAZY_FLAGS
+#define ALU_INC		lazyINC
+#define ALU_DEC		lazyDEC
+#define ALU_ADD		lazyADD
+#define ALU_ADC		lazyADC
+#define ALU_SUB		lazySUB
+#define ALU_SBC		lazySBC
+#define ALU_AND		lazyAND
+#define ALU_XOR		lazyXOR
+#define ALU_OR		lazyOR
+#define ALU_CP		lazyCP
+#define ALU_ADD_16	lazyADD_16
+
+// Brings F up to date before anything uses it directly
+#define RESOLVE_FLAGS() do { if (mLazyFlags.operation != LAZY_NONE) evaluateFlags(); } while (0)
+#else
+#ifdef TABLE_ALU
+#define ALU_INC		tableINC
+#define ALU_DEC		tableDEC
+#define ALU_ADD		tableADD
+#define ALU_ADC		tableADC
+#define ALU_SUB		tableSUB
+#define ALU_SBC		tableSBC
+#define ALU_CP		tableCP
+#else
+#define ALU_INC		INC
+#define ALU_DEC		DEC
+#define ALU_ADD		ADD
+#define ALU_ADC		ADC
+#define ALU_SUB		SUB
+#define ALU_SBC		SBC
+#define ALU_CP		CP
+#endif
+#define ALU_AND		AND
+#define ALU_XOR		XOR
+#define ALU_OR		OR
+#define ALU_ADD_16	ADD_16
+
+#define RESOLVE_FLAGS() do { } while (0)
+#endif
+
+void evaluateFlags(void);
+BYTE lazyZero(void);
+BYTE lazyCarry(void);
+
+BYTE lazyINC(BYTE);
+BYTE lazyDEC(BYTE);
+void lazyADD(BYTE);
+void lazyADC(BYTE);
+void lazySUB(BYTE);
+void lazySBC(BYTE);
+void lazyAND(BYTE);
+void lazyXOR(BYTE);
+void lazyOR(BYTE);
+void lazyCP(BYTE);
+void lazyADD_16(WORD);
+
+#endif
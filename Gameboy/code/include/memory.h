@@ -1,10 +1,56 @@
-#ifndef MEMORY_H
-#define MEMORY_H
-
-#include "hardware.h"
-
-BYTE readMemory(WORD);
-void writeMemory(WORD, BYTE);
-void pushStack(WORD);
-WORD popStack(void);
-#endif
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "hardware.h"
+#include "cartridge.h"
+
+/*
+	An instance made with forkGameBoy shares memory with the one it was forked from in 4 KB chunks, cpu[]
+	first and mExtRAM after it. A shared chunk is a copy both of them hold a reference to, and it stays
+	as it is until the last one lets go of it. The first write to a shared chunk goes through writeMemory,
+	which gives the writer a copy of its own. 0xF000 - 0xFFFF is never shared, the I/O ports, OAM and HRAM
+	in it are read straight out of cpu[].
+*/
+#define CHUNK_SIZE			0x1000
+#define MEMORY_CHUNKS		(0x10000 / CHUNK_SIZE)
+#define CHUNKS				(MEMORY_CHUNKS + MAX_EXT_RAM_SIZE / CHUNK_SIZE)
+#define MEMORY_CHUNK(address)	((address) / CHUNK_SIZE)
+#define EXT_RAM_CHUNK(offset)	(MEMORY_CHUNKS + (offset) / CHUNK_SIZE)
+#define PAGE_CHUNK(page)		((page) / (CHUNK_SIZE >> 8))
+
+// forkGameBoy shares every chunk but the one with the I/O ports. The ROM is shared as a whole
+#define IS_SHARED_CHUNK(chunk)	((chunk) != MEMORY_CHUNK(0xF000))
+
+/*
+	While dirty pages are tracked, every 256 byte page of cpu[] and mExtRAM that is written gets its bit set
+	in mDirtyPages, cpu[] first and mExtRAM after it like the chunks. Clean pages have no write pointer, so
+	only the first write to each one goes through writeMemory. The hardware writes 0xFE00 - 0xFFFF without
+	going through writeMemory, those two pages have to be taken as always dirty.
+*/
+#define MEMORY_PAGES			(0x10000 >> 8)
+#define DIRTY_PAGES				(MEMORY_PAGES + (MAX_EXT_RAM_SIZE >> 8))
+#define IS_DIRTY_PAGE(page)		(mDirtyPages[(page) >> 3] & (1 << ((page) & 7)))
+#define MARK_DIRTY_PAGE(page)	(mDirtyPages[(page) >> 3] |= (1 << ((page) & 7)))
+
+typedef struct
+{
+	volatile long references;
+	BYTE bytes[CHUNK_SIZE];
+} sharedChunk;
+
+void mapPage(BYTE);
+void mapBanks(void);
+void mapMemory(void);
+BYTE *chunkBytes(int);
+void ownChunk(int);
+void ownMemory(void);
+void releaseChunks(void);
+sharedChunk *shareChunk(int);
+void trackDirtyPages(int);
+void clearDirtyPages(void);
+BYTE readMemory(WORD);
+void writeMemory(WORD, BYTE);
+void transferOAM(BYTE);
+void pushStack(WORD);
+WORD popStack(void);
+#endif
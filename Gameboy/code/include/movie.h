@@ -0,0 +1,41 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include "hardware.h"
+
+// "GBMV" when the first four bytes of a file are read as text
+#define MOVIE_MAGIC		0x564D4247
+#define MOVIE_VERSION	1
+
+/*
+	A movie is a save state to start from and every change of the joypad after it, with the cycle it happened
+	on. Input can only change between two calls to cpuRun and cpuRun always stops on the first instruction that
+	ends at or after its target, so a replay that runs to the cycle of every change ends up exactly where the
+	recording did on any engine. The ROM and the state the recording ended in are kept as hashes, to tell
+	whether a movie belongs to the loaded cartridge and whether the replay got there.
+*/
+typedef struct movie movie;
+
+// Starts recording the current instance from where it is. Returns NULL when there isn't enough memory
+movie *recordMovie(void);
+
+// Use instead of setJoypad while recording, any other change to the joypad breaks the movie
+int recordJoypad(movie *, BYTE);
+void endMovie(movie *);
+
+void destroyMovie(movie *);
+int writeMovie(movie *, char *);
+movie *readMovie(char *);
+
+// startReplay loads the state the movie starts from and returns 0 when it was recorded from another cartridge.
+// replayMovie runs on for the given cycles feeding the joypad from the movie and returns how many it ran, 0 once
+// the movie is over. playMovie does both as fast as it can and returns 1 if it ended where the recording did
+int startReplay(movie *);
+int replayMovie(movie *, int);
+int playMovie(movie *);
+int replayMatches(movie *);
+
+CYCLES movieLength(movie *);
+int movieInputs(movie *);
+
+#endif
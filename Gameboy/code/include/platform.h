@@ -0,0 +1,49 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include "hardware.h"
+#include <stdio.h>
+
+/*
+	Everything the core needs from the program it runs in, so it builds without a window system or OpenGL.
+	The gpu hands every line it draws to the line sink and says when a frame is done through the frame sink,
+	debug logs go to the log sink and runFrame asks the input source for the joypad. Any of them can be NULL,
+	the core does without it then. The Windows front end (gameboy.c, display.c) draws with OpenGL and takes
+	input from its window, the headless one (headless.c) has no screen at all.
+*/
+typedef void(*lineSink)(const float *, int, void *);
+typedef void(*frameSink)(void *);
+typedef BYTE(*inputSource)(void *);
+typedef void(*logSink)(const char *, void *);
+
+typedef struct
+{
+	lineSink line;		// SCREEN_WIDTH RGB triples from 0 to 1 and the line they are on, from the top
+	frameSink frame;	// at the start of every VBLANK, after the last line
+	inputSource input;	// the joypad like setJoypad takes it
+	logSink log;		// one line of text at a time, ending in a newline
+	void *user;			// passed to every callback
+} platform;
+
+// The platform is shared by every instance, set it before any of them run
+void setPlatform(const platform *);
+
+void platformLine(const float *, int);
+void platformFrame(void);
+void platformLog(const char *, ...);
+
+// Sets the joypad from the input source and runs the current instance for a frame, returns the cycles run like cpuRun
+int runFrame(void);
+
+// The bounds checked functions of the Microsoft C library that the core uses, for every other toolchain
+#ifndef _MSC_VER
+static inline int fopen_s(FILE **file, const char *name, const char *mode)
+{
+	*file = fopen(name, mode);
+	return *file ? 0 : 1;
+}
+
+#define sprintf_s snprintf
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef RECOMPILER_H
+#define RECOMPILER_H
+
+#include "hardware.h"
+
+// A block of the cartridge that RECOMPILE_CARTRIDGE turned into a C function
+typedef void(*recompiledFunction)(CYCLES);
+
+typedef struct
+{
+	WORD bank;
+	WORD address;
+	recompiledFunction function;
+} recompiledBlock;
+
+// Most cartridges have far less code than this, the walk stops recording new blocks once it is reached
+#define MAX_RECOMPILED_BLOCKS 0x10000
+
+/*
+	The generated code runs every instruction with the same steps as runDecodedBlock, so a recompiled
+	block behaves exactly like the interpreter. Blocks expect target and codeChanges to be in scope.
+*/
+#define RECOMPILED_INSTRUCTION(last, next, handler) \
+	PC.pair = (last); \
+	handler; \
+	if (finishRecompiledInstruction((next), target, codeChanges)) return;
+
+int finishRecompiledInstruction(WORD, CYCLES, unsigned int);
+int RECOMPILE_CARTRIDGE(char *);
+
+// Building with RECOMPILED_CARTRIDGE links in a file made by RECOMPILE_CARTRIDGE, sorted by bank then address.
+// headless -recompile writes one and add_recompiled_headless in CMakeLists.txt builds with it
+#ifdef RECOMPILED_CARTRIDGE
+extern const recompiledBlock mRecompiledBlocks[];
+extern const int mRecompiledBlockCount;
+extern const WORD mRecompiledChecksum;
+
+// NULL when no block of the linked in cartridge starts at bank:address
+recompiledFunction findRecompiledBlock(WORD, WORD);
+void runRecompiled(CYCLES);
+#endif
+
+#endif
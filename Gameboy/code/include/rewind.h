@@ -0,0 +1,37 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "hardware.h"
+#include <stddef.h>
+
+/*
+	Keeps the last frames of one instance so it can be run backwards. Every frame is a delta save state
+	(see savestate.h) of the pages written during it, which is all the emulation thread pays for. A thread of
+	the rewinder's own XORs each delta with the frame before it and run length encodes it into a ring of a fixed
+	size, dropping the oldest frames when it runs out of room. XOR goes both ways, so stepping back a frame
+	only needs that one frame from the ring and the instance as it is.
+*/
+struct GameBoy;
+typedef struct rewinder rewinder;
+
+// Keeps at most the given number of frames in at most the given number of bytes. Returns NULL when there isn't
+// enough memory. The rewinder has to be destroyed before the instance
+rewinder *createRewinder(struct GameBoy *, int, size_t);
+void destroyRewinder(rewinder *);
+
+// Called after every frame the instance runs. The first call is frame 0
+void recordRewindFrame(rewinder *);
+
+// Return 0 without changing anything when the frame isn't kept anymore. Frames after the one the instance
+// ends up on are thrown away, recording goes on from there
+int stepBack(rewinder *);
+int rewindToFrame(rewinder *, unsigned int);
+
+// Frame the instance was on at the last call to recordRewindFrame, and the oldest frame it can go back to
+unsigned int newestRewindFrame(rewinder *);
+unsigned int oldestRewindFrame(rewinder *);
+
+// Bytes of the ring the kept frames take up
+size_t rewindBytes(rewinder *);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include "hardware.h"
+#include "cartridge.h"
+#include "interrupts.h"
+#include "timers.h"
+#include "scheduler.h"
+#include "memory.h"
+#include <stddef.h>
+
+// "GBST" when the first four bytes of a file are read as text
+#define SAVE_STATE_MAGIC	0x54534247
+#define SAVE_STATE_VERSION	2
+
+/*
+	Everything about a running Game Boy that isn't the ROM, memory or something the emulator works out again by
+	itself, like decoded blocks, compiled code and the memory map. It is one flat block without pointers, so
+	saving it is a few copies and a file holds the same bytes as memory. Events are kept as the cycle they are
+	due, each type always has the same callback so it is put back on load.
+*/
+typedef struct
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int size;			// of the whole saveState or deltaState, so builds that lay them out differently don't load each other's
+	BYTE title[16];				// of the cartridge it was taken from
+
+	Register af, bc, de, hl, sp, pc;
+	interruptStruct interrupts;
+	CYCLES cycles;
+	int halted;
+	int isStopped;
+	CYCLES eventCycles[EVENT_COUNT];
+	BYTE eventScheduled[EVENT_COUNT];
+	int gpuMode;
+	BYTE gpuLine;
+	CYCLES gpuModeEnd;
+	timerStruct timers;
+	Keys joypad;
+	memoryBankController mbc;
+} machineState;
+
+// A full snapshot
+typedef struct
+{
+	machineState machine;
+	BYTE memory[0x10000];
+	BYTE extRAM[MAX_EXT_RAM_SIZE];
+} saveState;
+
+/*
+	The machine and only the pages of memory written since the snapshot or delta before it, see DIRTY_PAGES.
+	A chain of deltas starts at a keyframe and each one can only be loaded on top of the state the one before
+	it left behind. The pages are in data in the order of pageMask, only the first pageCount are used and
+	DELTA_STATE_SIZE is how much of a delta there is to keep.
+*/
+typedef struct
+{
+	machineState machine;
+	int pageCount;
+	BYTE pageMask[DIRTY_PAGES / BITS_PER_BYTE];
+	BYTE data[DIRTY_PAGES][0x100];
+} deltaState;
+
+#define DELTA_STATE_SIZE(delta) (offsetof(deltaState, data) + (delta)->pageCount * sizeof((delta)->data[0]))
+
+// All of these work on the current instance between two calls to cpuRun. The loads return 0 and leave the
+// instance alone when the state is from another version or another cartridge
+void saveSnapshot(saveState *);
+int loadSnapshot(const saveState *);
+
+// A keyframe is a snapshot that also starts tracking the pages written, for the deltas after it. saveDelta returns 0
+// when there was no keyframe. Loading either one starts the next delta from the state that was loaded
+void saveKeyframe(saveState *);
+int saveDelta(deltaState *);
+int loadDelta(const deltaState *);
+
+// Return 0 when the file can't be opened, or for readSaveState when it doesn't hold a state loadSnapshot takes
+int writeSaveState(char *);
+int readSaveState(char *);
+
+#endif
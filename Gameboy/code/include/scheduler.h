@@ -0,0 +1,31 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "hardware.h"
+
+// Every piece of hardware that needs to do something at a certain cycle gets its own event
+typedef enum
+{
+	EVENT_GPU,
+	EVENT_TIMER,
+	EVENT_INTERRUPT,
+	EVENT_COUNT
+} eventType;
+
+// Events are called with the cycle they were scheduled for, which can be a little behind clock
+typedef void(*eventCallback)(CYCLES);
+
+typedef struct
+{
+	CYCLES when;
+	eventCallback callback;
+} event;
+
+void initializeScheduler(void);
+void scheduleEvent(eventType, CYCLES, eventCallback);
+void cancelEvent(eventType);
+int isEventScheduled(eventType);
+CYCLES eventCycle(eventType);
+void runEvents(void);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef STOPWATCH_H
+#define STOPWATCH_H
+
+// Seconds since some fixed point, only good for measuring how long something took. It lives in its own
+// file since the clock macro from context.h can't be in the same file as the system time headers
+double stopwatchSeconds(void);
+
+#endif
@@ -1 +1,3 @@
-void TEST_OPCODES(void);
\ No newline at end of file
+void TEST_OPCODES(void);
+int RUN_BENCHMARKS(char *);
+int WRITE_TEST_CARTRIDGE(char *);
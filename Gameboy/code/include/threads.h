@@ -0,0 +1,67 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+/*
+	Locks, condition variables and threads for the modules that run work on threads of their own, on top of
+	the Windows API or pthreads. A thread function is declared with THREAD_FUNCTION and ends with THREAD_RETURN.
+	Process wide state that is built on first use is built by a function declared with ONCE_FUNCTION, ending
+	with ONCE_RETURN, which RUN_ONCE calls exactly once however many threads get there at the same time.
+*/
+#ifdef _WIN32
+#ifndef WINDOWS_H
+#define WINDOWS_H
+#include <windows.h>
+#endif
+
+typedef CRITICAL_SECTION threadLock;
+typedef CONDITION_VARIABLE threadCondition;
+typedef HANDLE threadHandle;
+typedef INIT_ONCE threadOnce;
+
+#define INITIALIZE_LOCK(l)		InitializeCriticalSection(l)
+#define DESTROY_LOCK(l)			DeleteCriticalSection(l)
+#define LOCK(l)					EnterCriticalSection(l)
+#define UNLOCK(l)				LeaveCriticalSection(l)
+#define INITIALIZE_CONDITION(c)	InitializeConditionVariable(c)
+#define DESTROY_CONDITION(c)	do { } while (0)
+#define WAIT(c, l)				SleepConditionVariableCS(c, l, INFINITE)
+#define WAKE_ALL(c)				WakeAllConditionVariable(c)
+
+#define THREAD_FUNCTION(f, a)	DWORD WINAPI f(LPVOID a)
+#define THREAD_RETURN			return 0
+#define START_THREAD(t, f, a)	((t) = CreateThread(NULL, 0, f, a, 0, NULL))
+#define JOIN_THREAD(t)			do { WaitForSingleObject(t, INFINITE); CloseHandle(t); } while (0)
+
+#define ONCE_INITIALIZER		INIT_ONCE_STATIC_INIT
+#define ONCE_FUNCTION(f)		BOOL CALLBACK f(PINIT_ONCE once, PVOID parameter, PVOID *context)
+#define ONCE_RETURN				return TRUE
+#define RUN_ONCE(o, f)			InitOnceExecuteOnce(o, f, NULL, NULL)
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t threadLock;
+typedef pthread_cond_t threadCondition;
+typedef pthread_t threadHandle;
+typedef pthread_once_t threadOnce;
+
+#define INITIALIZE_LOCK(l)		pthread_mutex_init(l, NULL)
+#define DESTROY_LOCK(l)			pthread_mutex_destroy(l)
+#define LOCK(l)					pthread_mutex_lock(l)
+#define UNLOCK(l)				pthread_mutex_unlock(l)
+#define INITIALIZE_CONDITION(c)	pthread_cond_init(c, NULL)
+#define DESTROY_CONDITION(c)	pthread_cond_destroy(c)
+#define WAIT(c, l)				pthread_cond_wait(c, l)
+#define WAKE_ALL(c)				pthread_cond_broadcast(c)
+
+#define THREAD_FUNCTION(f, a)	void *f(void *a)
+#define THREAD_RETURN			return NULL
+#define START_THREAD(t, f, a)	pthread_create(&(t), NULL, f, a)
+#define JOIN_THREAD(t)			pthread_join(t, NULL)
+
+#define ONCE_INITIALIZER		PTHREAD_ONCE_INIT
+#define ONCE_FUNCTION(f)		void f(void)
+#define ONCE_RETURN				return
+#define RUN_ONCE(o, f)			pthread_once(o, f)
+#endif
+
+#endif
@@ -1,7 +1,25 @@
-#ifndef TIMERS_H
-#define TIMERS_H
-void dividerRegister(int);
-void timerStep(void);
-void setFrequency(void);
-unsigned char getFrequency(void);
-#endif
+#ifndef TIMERS_H
+#define TIMERS_H
+#include "hardware.h"
+
+// Everything the timers need to work out DIV and TIMA for any cycle
+typedef struct
+{
+	CYCLES dividerStart;	// when the counter behind DIV was last reset
+	CYCLES counterStart;	// when TIMA was last brought up to date
+	BYTE counter;			// TIMA at counterStart
+} timerStruct;
+
+void initializeTimers(void);
+void updateTimer(void);
+void scheduleTimer(void);
+void timerStep(CYCLES);
+unsigned char getFrequency(void);
+
+// I/O handlers for 0xFF04 - 0xFF07
+BYTE readDivider(void);
+void writeDivider(BYTE);
+BYTE readTimerCounter(void);
+void writeTimerCounter(BYTE);
+void writeTimerControl(BYTE);
+#endif
@@ -1,92 +1,127 @@
-#include "interrupts.h"
-#include "hardware.h"
-#include "memory.h"
-#include "display.h"
-
-void interruptStep()
-{
-	if (interrupt.master && interrupt.enable && interrupt.flags)
-	{
-		BYTE fire = interrupt.enable & interrupt.flags;
-		if ((interrupt.flags & INTERRUPTS_VBLANK)
-			| (interrupt.flags & INTERRUPTS_LCDSTAT)
-			| (interrupt.flags & INTERRUPTS_TIMER)
-			| (interrupt.flags & INTERRUPTS_SERIAL)
-			| (interrupt.flags & INTERRUPTS_JOYPAD))
-		{
-			// Stop halting if we enter an interrupt
-			halt = 0;
-		}
-
-		if (fire & INTERRUPTS_VBLANK)
-		{
-			interrupt.flags &= ~INTERRUPTS_VBLANK;
-			vblank();
-		}
-
-		if (fire & INTERRUPTS_LCDSTAT)
-		{
-			interrupt.flags &= ~INTERRUPTS_LCDSTAT;
-			lcdStat();
-		}
-
-		if (fire & INTERRUPTS_TIMER)
-		{
-			interrupt.flags &= ~INTERRUPTS_TIMER;
-			timer();
-		}
-
-		if (fire & INTERRUPTS_SERIAL)
-		{
-			interrupt.flags &= ~INTERRUPTS_SERIAL;
-			serial();
-		}
-
-		if (fire & INTERRUPTS_JOYPAD)
-		{
-			interrupt.flags &= ~INTERRUPTS_JOYPAD;
-			joypad();
-		}
-	}
-}
-
-void vblank()
-{
-	interrupt.master = 0;
-	pushStack(PC.pair);
-	PC.pair = 0x40;
-	drawScreen();
-	clock += 12;
-}
-
-void lcdStat()
-{
-	interrupt.master = 0;
-	pushStack(PC.pair);
-	PC.pair = 0x48;
-	clock += 12;
-}
-
-void timer()
-{
-	interrupt.master = 0;
-	pushStack(PC.pair);
-	PC.pair = 0x50;
-	clock += 12;
-}
-
-void serial()
-{
-	interrupt.master = 0;
-	pushStack(PC.pair);
-	PC.pair = 0x58;
-	clock += 12;
-}
-
-void joypad()
-{
-	interrupt.master = 0;
-	pushStack(PC.pair);
-	PC.pair = 0x60;
-	clock += 12;
-}
+#include "interrupts.h"
+#include "hardware.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "context.h"
+
+void updateInterrupts()
+{
+	BYTE raised = interrupt.enable & interrupt.flags & INTERRUPTS_ALL;
+
+	// With IME off an interrupt still ends a halt, it just isn't taken
+	if (halt && !interrupt.master && raised)
+	{
+		halt = 0;
+	}
+
+	interrupt.pending = interrupt.master ? raised : 0;
+
+	if (!interrupt.pending)
+	{
+		cancelEvent(EVENT_INTERRUPT);
+	}
+	else if (!isEventScheduled(EVENT_INTERRUPT))
+	{
+		scheduleEvent(EVENT_INTERRUPT, clock, interruptStep);
+	}
+}
+
+// Called by the hardware that raises an interrupt
+void requestInterrupt(BYTE interrupts)
+{
+	interrupt.flags |= interrupts;
+	updateInterrupts();
+}
+
+/*
+	EI lets interrupts in after the instruction that follows it. That instruction always moves clock on,
+	so an interrupt that is pending right away is taken by an event due one cycle from now.
+*/
+void enableInterrupts()
+{
+	interrupt.master = 1;
+	updateInterrupts();
+
+	if (interrupt.pending)
+	{
+		scheduleEvent(EVENT_INTERRUPT, clock + 1, interruptStep);
+	}
+}
+
+void disableInterrupts()
+{
+	interrupt.master = 0;
+	updateInterrupts();
+}
+
+// Called by the scheduler while an interrupt is pending, only the one with the highest priority is taken
+void interruptStep(CYCLES due)
+{
+	// The lowest bit has the highest priority
+	BYTE fire = interrupt.pending & (BYTE)(-interrupt.pending);
+
+	// Stop halting if we enter an interrupt
+	halt = 0;
+	interrupt.flags &= ~fire;
+
+	switch (fire)
+	{
+	case INTERRUPTS_VBLANK:
+		vblank();
+		break;
+	case INTERRUPTS_LCDSTAT:
+		lcdStat();
+		break;
+	case INTERRUPTS_TIMER:
+		timer();
+		break;
+	case INTERRUPTS_SERIAL:
+		serial();
+		break;
+	case INTERRUPTS_JOYPAD:
+		joypad();
+		break;
+	}
+
+	updateInterrupts();
+}
+
+void vblank()
+{
+	interrupt.master = 0;
+	pushStack(PC.pair);
+	PC.pair = 0x40;
+	clock += 12;
+}
+
+void lcdStat()
+{
+	interrupt.master = 0;
+	pushStack(PC.pair);
+	PC.pair = 0x48;
+	clock += 12;
+}
+
+void timer()
+{
+	interrupt.master = 0;
+	pushStack(PC.pair);
+	PC.pair = 0x50;
+	clock += 12;
+}
+
+void serial()
+{
+	interrupt.master = 0;
+	pushStack(PC.pair);
+	PC.pair = 0x58;
+	clock += 12;
+}
+
+void joypad()
+{
+	interrupt.master = 0;
+	pushStack(PC.pair);
+	PC.pair = 0x60;
+	clock += 12;
+}
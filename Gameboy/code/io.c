@@ -0,0 +1,102 @@
+#include "io.h"
+#include "memory.h"
+#include "timers.h"
+#include "gpu.h"
+#include "interrupts.h"
+
+#include "context.h"
+
+// IF and IE are kept in the interrupt struct only
+BYTE readInterruptFlags()
+{
+	return interrupt.flags;
+}
+
+void writeInterruptFlags(BYTE data)
+{
+	interrupt.flags = data;
+	updateInterrupts();
+}
+
+void writeInterruptEnable(BYTE data)
+{
+	interrupt.enable = data;
+	updateInterrupts();
+}
+
+// Every instance reads the same handlers, the tables are built by the compiler so nothing writes them at run time
+const ioReadHandler mIORead[IO_PORTS] =
+{
+	// Joypad
+	[0x00] = readJoypad,
+
+	// Timers
+	[0x04] = readDivider,
+	[0x05] = readTimerCounter,
+
+	// Interrupts
+	[0x0F] = readInterruptFlags,
+
+	// LCD
+	[0x41] = readLcdStatus,
+	[0x44] = readScanline,
+};
+
+const ioWriteHandler mIOWrite[IO_PORTS] =
+{
+	// Joypad
+	[0x00] = writeJoypad,
+
+	// Timers
+	[0x04] = writeDivider,
+	[0x05] = writeTimerCounter,
+	[0x07] = writeTimerControl,
+
+	// Interrupts
+	[0x0F] = writeInterruptFlags,
+
+	// LCD
+	[0x40] = writeLcdControl,
+	[0x41] = writeLcdStatus,
+	[0x42] = writeScrollY,
+	[0x43] = writeScrollX,
+	[0x44] = writeScanline,
+	[0x45] = writeLyCompare,
+	[0x46] = transferOAM,
+	[0x47] = writeBackgroundPalette,
+	[0x48] = writeObjectPalette0,
+	[0x49] = writeObjectPalette1,
+	[0x4A] = writeWindowY,
+	[0x4B] = writeWindowX,
+};
+
+BYTE readIO(WORD address)
+{
+	if (address == 0xFFFF)
+	{
+		return interrupt.enable;
+	}
+
+	if ((address < 0xFF80) && mIORead[address & 0x7F])
+	{
+		return mIORead[address & 0x7F]();
+	}
+
+	return cpu[address];
+}
+
+void writeIO(WORD address, BYTE data)
+{
+	if (address == 0xFFFF)
+	{
+		writeInterruptEnable(data);
+	}
+	else if ((address < 0xFF80) && mIOWrite[address & 0x7F])
+	{
+		mIOWrite[address & 0x7F](data);
+	}
+	else
+	{
+		cpu[address] = data;
+	}
+}
@@ -0,0 +1,570 @@
+#include "jit.h"
+#include "cpu.h"
+#include "cartridge.h"
+#include "interrupts.h"
+#include "scheduler.h"
+#include "lazyflags.h"
+#include "memory.h"
+#include "timers.h"
+#include "platform.h"
+#include "threads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef JIT_SUPPORTED
+#ifdef _WIN32
+#ifndef WINDOWS_H
+#define WINDOWS_H
+#include <windows.h>
+#endif
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+#include "context.h"
+
+/*
+	The jit turns hot blocks from the block cache into x86-64 that calls the opcode handlers one after
+	another, so the dispatch switch and the loop around it go away but every instruction still does exactly
+	what the interpreter would. Between two instructions the compiled code only calls back into C when an
+	event is due, which includes taking a pending interrupt, the same case afterInstruction handles. Blocks
+	are left early once any code could have changed under them (mCodeChanges), the block cache then decides
+	whether they are still current.
+*/
+
+typedef void(*nativeBlock)(void);
+
+int mJitVerify = 0;
+
+#ifdef JIT_SUPPORTED
+
+// Worst case size of the code for one block, each instruction takes a little under 200 bytes
+#define MAX_NATIVE_BLOCK_SIZE (256 * MAX_BLOCK_INSTRUCTIONS + 64)
+
+// Called from compiled code when something has to happen between two instructions. Returns 1 when the block has to be left
+int jitAfterInstruction(unsigned int next)
+{
+	afterInstruction();
+
+	return (PC.pair != next) || halt || stopped || (clock >= mJitTarget);
+}
+
+int allocateJitCode()
+{
+	if (mJitCode)
+	{
+		return 1;
+	}
+
+#ifdef _WIN32
+	mJitCode = (BYTE*)VirtualAlloc(NULL, JIT_CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+	void *code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	mJitCode = (code == MAP_FAILED) ? NULL : (BYTE*)code;
+#endif
+
+	return mJitCode != NULL;
+}
+
+#ifdef __linux__
+// One map for the whole process, every instance compiling on its own thread adds to it. Each line is written
+// with a single fprintf, which holds the file's lock, so lines from different threads don't mix
+FILE *mPerfMap = NULL;
+threadOnce mPerfMapOpened = ONCE_INITIALIZER;
+
+ONCE_FUNCTION(openPerfMap)
+{
+	char name[64];
+	snprintf(name, sizeof(name), "/tmp/perf-%d.map", (int)getpid());
+
+	mPerfMap = fopen(name, "w");
+	ONCE_RETURN;
+}
+
+// perf picks up /tmp/perf-PID.map to name code it finds no symbols for, each block shows up as gb_BANK_ADDRESS
+void writePerfMap(decodedBlock *block, BYTE *code, unsigned int size)
+{
+	RUN_ONCE(&mPerfMapOpened, openPerfMap);
+	if (!mPerfMap)
+	{
+		return;
+	}
+
+	fprintf(mPerfMap, "%llx %x gb_%02x_%04x\n", (unsigned long long)(size_t)code, size, block->bank, block->address);
+	fflush(mPerfMap);
+}
+#endif
+
+/* ------ x86-64 EMITTER ------ */
+
+void emitByte(BYTE value)
+{
+	*mEmit++ = value;
+}
+
+void emitWord(WORD value)
+{
+	memcpy(mEmit, &value, sizeof(value));
+	mEmit += sizeof(value);
+}
+
+void emitDword(unsigned int value)
+{
+	memcpy(mEmit, &value, sizeof(value));
+	mEmit += sizeof(value);
+}
+
+// mov rax, imm64
+void emitMovRax(const void *value)
+{
+	unsigned long long address = (unsigned long long)(size_t)value;
+
+	emitByte(0x48);
+	emitByte(0xB8);
+	memcpy(mEmit, &address, sizeof(address));
+	mEmit += sizeof(address);
+}
+
+// mov rdx, imm64
+void emitMovRdx(const void *value)
+{
+	unsigned long long address = (unsigned long long)(size_t)value;
+
+	emitByte(0x48);
+	emitByte(0xBA);
+	memcpy(mEmit, &address, sizeof(address));
+	mEmit += sizeof(address);
+}
+
+// Loads the first integer argument, ecx on Windows and edi everywhere else
+void emitFirstArgument(unsigned int value)
+{
+#ifdef _WIN32
+	emitByte(0xB9);
+#else
+	emitByte(0xBF);
+#endif
+	emitDword(value);
+}
+
+// mov rax, function / call rax
+void emitCall(const void *function)
+{
+	emitMovRax(function);
+	emitByte(0xFF);
+	emitByte(0xD0);
+}
+
+// Condition codes, short jumps use 0x70 + code and near jumps 0x0F 0x80 + code
+#define JUMP_B	0x02
+#define JUMP_AE	0x03
+#define JUMP_E	0x04
+#define JUMP_NE	0x05
+
+// Emits a short conditional jump and returns where its displacement goes so it can be patched once the target is known
+BYTE *emitJump8(BYTE condition)
+{
+	emitByte(0x70 + condition);
+	emitByte(0x00);
+
+	return mEmit - 1;
+}
+
+void patchJump8(BYTE *displacement)
+{
+	*displacement = (BYTE)(mEmit - (displacement + 1));
+}
+
+BYTE *emitJump32(BYTE condition)
+{
+	emitByte(0x0F);
+	emitByte(0x80 + condition);
+	emitDword(0);
+
+	return mEmit - 4;
+}
+
+void patchJump32(BYTE *displacement, BYTE *target)
+{
+	int relative = (int)(target - (displacement + 4));
+	memcpy(displacement, &relative, sizeof(relative));
+}
+
+// The handlers that take a SIGNED_BYTE need the operand sign extended, the others take it as is
+unsigned int handlerArgument(decodedInstruction *instruction)
+{
+	switch (instruction->opcode)
+	{
+	case 0x18:	// JR
+	case 0xe8:	// ADD SP
+	case 0xf8:	// LD HL, SP + n
+		return (unsigned int)(int)(SIGNED_BYTE)instruction->operand;
+	default:
+		return instruction->operand;
+	}
+}
+
+/*
+	Every instruction becomes:
+		PC = last byte of the instruction, handler(operand), PC++
+		if clock >= mNextEvent or clock >= mJitTarget:
+			if jitAfterInstruction(next) leave the block
+		if mCodeChanges moved since the block was entered leave the block
+	The value of mCodeChanges on entry lives in rbx, which every ABI keeps across calls.
+*/
+void *compileBlock(decodedBlock *block)
+{
+	BYTE *exits[MAX_BLOCK_INSTRUCTIONS * 2];
+	int exitCount = 0;
+	WORD next = block->address;
+	int i;
+
+	if (!allocateJitCode())
+	{
+		return NULL;
+	}
+
+	if (mJitUsed + MAX_NATIVE_BLOCK_SIZE > JIT_CODE_SIZE)
+	{
+		flushJit();
+	}
+
+	BYTE *start = mJitCode + mJitUsed;
+	mEmit = start;
+
+	// push rbx / sub rsp, 32. Keeps the stack 16 byte aligned for calls and leaves the shadow space Windows needs
+	emitByte(0x53);
+	emitByte(0x48); emitByte(0x83); emitByte(0xEC); emitByte(0x20);
+
+	// mov rax, &mCodeChanges / mov ebx, [rax]
+	emitMovRax(&mCodeChanges);
+	emitByte(0x8B); emitByte(0x18);
+
+	for (i = 0; i < block->count; i++)
+	{
+		decodedInstruction *instruction = &block->instructions[i];
+		BYTE *slowPath;
+		BYTE *skipSlowPath;
+
+		next += instruction->length;
+
+		// mov rax, &PC / mov word [rax], next - 1
+		emitMovRax(&PC.pair);
+		emitByte(0x66); emitByte(0xC7); emitByte(0x00);
+		emitWord((WORD)(next - 1));
+
+		emitFirstArgument(handlerArgument(instruction));
+		emitCall(mOpcodes[instruction->opcode].function);
+
+		// mov rax, &PC / add word [rax], 1
+		emitMovRax(&PC.pair);
+		emitByte(0x66); emitByte(0x83); emitByte(0x00); emitByte(0x01);
+
+		// mov rax, &clock / mov rax, [rax]
+		emitMovRax(&clock);
+		emitByte(0x48); emitByte(0x8B); emitByte(0x00);
+
+		// mov rdx, &mNextEvent / cmp rax, [rdx] / jae slow
+		emitMovRdx(&mNextEvent);
+		emitByte(0x48); emitByte(0x3B); emitByte(0x02);
+		slowPath = emitJump8(JUMP_AE);
+
+		// mov rdx, &mJitTarget / cmp rax, [rdx] / jb ok
+		emitMovRdx(&mJitTarget);
+		emitByte(0x48); emitByte(0x3B); emitByte(0x02);
+		skipSlowPath = emitJump8(JUMP_B);
+
+		patchJump8(slowPath);
+
+		// jitAfterInstruction(next) / test eax, eax / jnz exit
+		emitFirstArgument(next);
+		emitCall((const void*)jitAfterInstruction);
+		emitByte(0x85); emitByte(0xC0);
+		exits[exitCount++] = emitJump32(JUMP_NE);
+
+		patchJump8(skipSlowPath);
+
+		// mov rax, &mCodeChanges / cmp [rax], ebx / jne exit
+		emitMovRax(&mCodeChanges);
+		emitByte(0x39); emitByte(0x18);
+		exits[exitCount++] = emitJump32(JUMP_NE);
+	}
+
+	for (i = 0; i < exitCount; i++)
+	{
+		patchJump32(exits[i], mEmit);
+	}
+
+	// add rsp, 32 / pop rbx / ret
+	emitByte(0x48); emitByte(0x83); emitByte(0xC4); emitByte(0x20);
+	emitByte(0x5B);
+	emitByte(0xC3);
+
+	unsigned int size = (unsigned int)(mEmit - start);
+	mJitUsed += size;
+
+#ifdef __linux__
+	writePerfMap(block, start, size);
+#endif
+
+	return start;
+}
+
+/* ------ DIFFERENTIAL MODE ------ */
+
+/*
+	Everything a block can change that can be put back afterwards. Events can't be, only their deadlines are kept
+	to spot them. A write over code invalidates it, which is kept too so the second run of a block that writes
+	over code leaves at the same write as the first.
+*/
+typedef struct
+{
+	Register af, bc, de, hl, sp, pc;
+	CYCLES cycles;
+	unsigned int codeChanges;
+	unsigned int pageVersion[0x100];
+	BYTE codeBytes[0x10000 / BITS_PER_BYTE];
+	interruptStruct interrupts;
+	timerStruct timer;
+	int halted;
+	int isStopped;
+	memoryBankController mbc;
+	CYCLES events[EVENT_COUNT];
+	BYTE memory[0x10000];
+	BYTE extRAM[MAX_EXT_RAM_SIZE];
+} jitState;
+
+// About 200 KB each, so an instance only gets them the first time it verifies a block
+typedef struct jitScratch
+{
+	jitState before;
+	jitState interpreted;
+	jitState compiled;
+} jitScratch;
+
+void saveJitState(jitState *state)
+{
+	int i;
+
+	// Snapshots always hold F up to date so both runs can be compared. Memory is copied straight out of cpu[],
+	// so chunks shared with other instances have to be copied into it first
+	RESOLVE_FLAGS();
+	ownMemory();
+
+	state->af = registerAF;
+	state->bc = registerBC;
+	state->de = registerDE;
+	state->hl = registerHL;
+	state->sp = SP;
+	state->pc = PC;
+	state->cycles = clock;
+	state->codeChanges = mCodeChanges;
+	memcpy(state->pageVersion, mPageVersion, sizeof(state->pageVersion));
+	memcpy(state->codeBytes, mCodeBytes, sizeof(state->codeBytes));
+	state->interrupts = interrupt;
+	state->timer = mTimer;
+	state->halted = halt;
+	state->isStopped = stopped;
+	state->mbc = mMBC;
+
+	for (i = 0; i < EVENT_COUNT; i++)
+	{
+		state->events[i] = isEventScheduled((eventType)i) ? eventCycle((eventType)i) : ~(CYCLES)0;
+	}
+
+	memcpy(state->memory, cpu, sizeof(state->memory));
+	memcpy(state->extRAM, mExtRAM, sizeof(state->extRAM));
+}
+
+void loadJitState(jitState *state)
+{
+	registerAF = state->af;
+	mLazyFlags.operation = LAZY_NONE;
+	registerBC = state->bc;
+	registerDE = state->de;
+	registerHL = state->hl;
+	SP = state->sp;
+	PC = state->pc;
+	clock = state->cycles;
+	mCodeChanges = state->codeChanges;
+	memcpy(mPageVersion, state->pageVersion, sizeof(mPageVersion));
+	memcpy(mCodeBytes, state->codeBytes, sizeof(mCodeBytes));
+	interrupt = state->interrupts;
+	mTimer = state->timer;
+	halt = state->halted;
+	stopped = state->isStopped;
+	mMBC = state->mbc;
+
+	// Pages with code on them only take writes through writeMemory, so the whole map follows the code bytes
+	mapMemory();
+
+	memcpy(cpu, state->memory, sizeof(state->memory));
+	memcpy(mExtRAM, state->extRAM, sizeof(state->extRAM));
+}
+
+void logJitMismatch(decodedBlock *block)
+{
+	jitState *interpreted = &mJitScratch->interpreted;
+	jitState *compiled = &mJitScratch->compiled;
+	int i;
+
+	platformLog("block %02X:%04X\n", block->bank, block->address);
+	platformLog("  interpreter AF: %04X, BC: %04X, DE: %04X, HL: %04X, SP: %04X, PC: %04X, clock: %llu\n",
+		interpreted->af.pair, interpreted->bc.pair, interpreted->de.pair, interpreted->hl.pair, interpreted->sp.pair, interpreted->pc.pair, interpreted->cycles);
+	platformLog("  jit         AF: %04X, BC: %04X, DE: %04X, HL: %04X, SP: %04X, PC: %04X, clock: %llu\n",
+		compiled->af.pair, compiled->bc.pair, compiled->de.pair, compiled->hl.pair, compiled->sp.pair, compiled->pc.pair, compiled->cycles);
+
+	for (i = 0; i < 0x10000; i++)
+	{
+		if (interpreted->memory[i] != compiled->memory[i])
+		{
+			platformLog("  first memory difference at %04X: %02X / %02X\n", i, interpreted->memory[i], compiled->memory[i]);
+			break;
+		}
+	}
+}
+
+int sameJitState(jitState *a, jitState *b)
+{
+	return (a->af.pair == b->af.pair) && (a->bc.pair == b->bc.pair) && (a->de.pair == b->de.pair)
+		&& (a->hl.pair == b->hl.pair) && (a->sp.pair == b->sp.pair) && (a->pc.pair == b->pc.pair)
+		&& (a->cycles == b->cycles) && !memcmp(&a->interrupts, &b->interrupts, sizeof(a->interrupts))
+		&& (a->timer.dividerStart == b->timer.dividerStart) && (a->timer.counterStart == b->timer.counterStart)
+		&& (a->timer.counter == b->timer.counter)
+		&& (a->halted == b->halted) && (a->isStopped == b->isStopped) && !memcmp(&a->mbc, &b->mbc, sizeof(a->mbc))
+		&& !memcmp(a->memory, b->memory, sizeof(a->memory)) && !memcmp(a->extRAM, b->extRAM, sizeof(a->extRAM));
+}
+
+/*
+	Runs the block with the interpreter, rewinds and runs the compiled code, then compares the two.
+	The interpreter's result is always the one that is kept. If an event ran during the block the
+	rewind wouldn't be complete, so those runs aren't compared. Without the memory to compare in the block
+	only runs in the interpreter.
+*/
+void runVerified(decodedBlock *block, CYCLES target)
+{
+	if (!mJitScratch)
+	{
+		mJitScratch = (jitScratch*)malloc(sizeof(jitScratch));
+		if (!mJitScratch)
+		{
+			runDecodedBlock(block, target);
+			return;
+		}
+	}
+
+	saveJitState(&mJitScratch->before);
+	runDecodedBlock(block, target);
+	saveJitState(&mJitScratch->interpreted);
+
+	if (memcmp(mJitScratch->before.events, mJitScratch->interpreted.events, sizeof(mJitScratch->before.events)))
+	{
+		return;
+	}
+
+	loadJitState(&mJitScratch->before);
+	mJitTarget = target;
+	((nativeBlock)block->native)();
+	saveJitState(&mJitScratch->compiled);
+
+	if (!sameJitState(&mJitScratch->interpreted, &mJitScratch->compiled))
+	{
+		mJitMismatches++;
+		logJitMismatch(block);
+
+		// Never compile this block again
+		block->native = NULL;
+		block->runs = JIT_THRESHOLD;
+	}
+
+	loadJitState(&mJitScratch->interpreted);
+}
+
+#endif
+
+void flushJit()
+{
+#ifdef JIT_SUPPORTED
+	mJitUsed = 0;
+	mJitEpoch++;
+#endif
+}
+
+// Gives the code buffer and verify states of the current instance back, called when it is destroyed
+void freeJitCode()
+{
+#ifdef JIT_SUPPORTED
+	free(mJitScratch);
+	mJitScratch = NULL;
+
+	if (!mJitCode)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	VirtualFree(mJitCode, 0, MEM_RELEASE);
+#else
+	munmap(mJitCode, JIT_CODE_SIZE);
+#endif
+	mJitCode = NULL;
+	mJitUsed = 0;
+#endif
+}
+
+// Runs the block at PC, compiled if it is hot enough and from the block cache otherwise
+void runJit(CYCLES target)
+{
+	decodedBlock *block = NULL;
+
+	if (!halt && !PRINT_LOGS)
+	{
+		block = getBlock(PC.pair);
+	}
+
+	if (!block)
+	{
+		stepInstruction();
+		return;
+	}
+
+	CYCLES start = clock;
+	CYCLES nextEvent = mNextEvent;
+
+#ifdef JIT_SUPPORTED
+	if (block->native && (block->nativeEpoch != mJitEpoch))
+	{
+		// Compiled before the code buffer was flushed
+		block->native = NULL;
+		block->runs = 0;
+	}
+
+	if (!block->native && (++block->runs == JIT_THRESHOLD))
+	{
+		block->native = compileBlock(block);
+		block->nativeEpoch = mJitEpoch;
+	}
+
+	if (block->native)
+	{
+		if (mJitVerify)
+		{
+			runVerified(block, target);
+		}
+		else
+		{
+			mJitTarget = target;
+			((nativeBlock)block->native)();
+		}
+
+		skipIdleLoop(block, start, nextEvent, target);
+		return;
+	}
+#endif
+
+	runDecodedBlock(block, target);
+	skipIdleLoop(block, start, nextEvent, target);
+}
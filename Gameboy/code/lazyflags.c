@@ -0,0 +1,190 @@
+#include "lazyflags.h"
+#include "context.h"
+
+/*
+	Every lazy helper has to leave F exactly the way its eager version in opcodes.c would, including
+	the quirks of ADC and SBC adding the carry to the operand before the flags are worked out.
+	TEST_LAZY_FLAGS in test_cases.c checks them against each other.
+*/
+
+// Z of the last operation without working out the other flags
+BYTE lazyZero()
+{
+	switch (mLazyFlags.operation)
+	{
+	case LAZY_NONE:
+		return registerAF.lo & FLAG_Z;
+	case LAZY_ADD_16:
+		return mLazyFlags.zero;
+	default:
+		return (mLazyFlags.result == 0) ? FLAG_Z : 0;
+	}
+}
+
+// C of the last operation without working out the other flags
+BYTE lazyCarry()
+{
+	switch (mLazyFlags.operation)
+	{
+	case LAZY_NONE:
+		return registerAF.lo & FLAG_C;
+	case LAZY_ADD:
+		return ((mLazyFlags.a + mLazyFlags.b) > 0xFF) ? FLAG_C : 0;
+	case LAZY_SUB:
+		return (mLazyFlags.b > mLazyFlags.a) ? FLAG_C : 0;
+	case LAZY_INC:
+	case LAZY_DEC:
+		return mLazyFlags.carry;
+	case LAZY_ADD_16:
+		return (((unsigned long)mLazyFlags.a + mLazyFlags.b) > 0xFFFF) ? FLAG_C : 0;
+	default:
+		return 0;
+	}
+}
+
+void evaluateFlags()
+{
+	BYTE flags = 0;
+
+	switch (mLazyFlags.operation)
+	{
+	case LAZY_NONE:
+		return;
+	case LAZY_ADD:
+		if (((mLazyFlags.a & 0xF) + (mLazyFlags.b & 0xF)) & 0x10)
+		{
+			flags |= FLAG_H;
+		}
+		break;
+	case LAZY_SUB:
+		flags |= FLAG_N;
+		if ((mLazyFlags.b & 0xF) > (mLazyFlags.a & 0xF))
+		{
+			flags |= FLAG_H;
+		}
+		break;
+	case LAZY_AND:
+		flags |= FLAG_H;
+		break;
+	case LAZY_OR:
+		break;
+	case LAZY_INC:
+		if ((mLazyFlags.a & 0xF) == 0xF)
+		{
+			flags |= FLAG_H;
+		}
+		break;
+	case LAZY_DEC:
+		flags |= FLAG_N;
+		if (!(mLazyFlags.a & 0x0F))
+		{
+			flags |= FLAG_H;
+		}
+		break;
+	case LAZY_ADD_16:
+		if (((mLazyFlags.a & 0xFFF) + (mLazyFlags.b & 0xFFF)) & 0x1000)
+		{
+			flags |= FLAG_H;
+		}
+		break;
+	}
+
+	flags |= lazyZero() | lazyCarry();
+
+	// The low nibble of F isn't a flag, it keeps whatever was in it
+	registerAF.lo = (registerAF.lo & 0x0F) | flags;
+	mLazyFlags.operation = LAZY_NONE;
+}
+
+BYTE lazyINC(BYTE r)
+{
+	mLazyFlags.carry = lazyCarry();
+	mLazyFlags.operation = LAZY_INC;
+	mLazyFlags.a = r;
+	mLazyFlags.result = (BYTE)(r + 1);
+
+	return mLazyFlags.result;
+}
+
+BYTE lazyDEC(BYTE r)
+{
+	mLazyFlags.carry = lazyCarry();
+	mLazyFlags.operation = LAZY_DEC;
+	mLazyFlags.a = r;
+	mLazyFlags.result = (BYTE)(r - 1);
+
+	return mLazyFlags.result;
+}
+
+void lazyADD(BYTE r)
+{
+	mLazyFlags.operation = LAZY_ADD;
+	mLazyFlags.a = registerAF.hi;
+	mLazyFlags.b = r;
+
+	registerAF.hi += r;
+	mLazyFlags.result = registerAF.hi;
+}
+
+void lazyADC(BYTE r)
+{
+	lazyADD(r + (lazyCarry() ? 1 : 0));
+}
+
+void lazySUB(BYTE r)
+{
+	mLazyFlags.operation = LAZY_SUB;
+	mLazyFlags.a = registerAF.hi;
+	mLazyFlags.b = r;
+
+	registerAF.hi -= r;
+	mLazyFlags.result = registerAF.hi;
+}
+
+void lazySBC(BYTE r)
+{
+	lazySUB(r + (lazyCarry() ? 1 : 0));
+}
+
+void lazyAND(BYTE r)
+{
+	registerAF.hi &= r;
+
+	mLazyFlags.operation = LAZY_AND;
+	mLazyFlags.result = registerAF.hi;
+}
+
+void lazyXOR(BYTE r)
+{
+	registerAF.hi ^= r;
+
+	mLazyFlags.operation = LAZY_OR;
+	mLazyFlags.result = registerAF.hi;
+}
+
+void lazyOR(BYTE r)
+{
+	registerAF.hi |= r;
+
+	mLazyFlags.operation = LAZY_OR;
+	mLazyFlags.result = registerAF.hi;
+}
+
+// Same flags as SUB, A just isn't changed
+void lazyCP(BYTE r)
+{
+	mLazyFlags.operation = LAZY_SUB;
+	mLazyFlags.a = registerAF.hi;
+	mLazyFlags.b = r;
+	mLazyFlags.result = (BYTE)(registerAF.hi - r);
+}
+
+void lazyADD_16(WORD r)
+{
+	mLazyFlags.zero = lazyZero();
+	mLazyFlags.operation = LAZY_ADD_16;
+	mLazyFlags.a = registerHL.pair;
+	mLazyFlags.b = r;
+
+	registerHL.pair += r;
+}
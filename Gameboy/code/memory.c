@@ -1,250 +1,528 @@
-#include "hardware.h"
-#include "cartridge.h"
-#include "timers.h"
-#include "interrupts.h"
-#include <stdio.h>
-
-BYTE readMemory(WORD address)
-{
-	/* ------ MEMORY BANK CONTROLLER ADDRESSES ------ */
-
-	// Address 0x0000 to 0x3FFF is always ROM Bank #0
-	if ((address >= 0x0000) && (address < 0x4000))
-	{
-		return mCartridge[address];
-	}
-	// Address 0x4000 - 0x7FFF is the switchable ROM bank
-	else if ((address >= 0x4000) && (address < 0x8000))
-	{
-		unsigned long targetAddress = address - 0x4000;	// This will bring our address between 0x0000 and 0x4000
-
-		unsigned long cartridgeAddress = (mMBC.romBank * ROM_BANK_SIZE) + targetAddress;	// 0x4000 addresses per ROM bank
-
-		return mCartridge[cartridgeAddress];
-	}
-	else if ((address >= 0xA000) && (address < 0xC000))
-	{
-		unsigned long targetAddress = address - 0xA000;
-		unsigned long ramAddress = (mMBC.ramBank * RAM_BANK_SIZE) + targetAddress;
-
-		return mExtRAM[ramAddress];
-	}
-	else if ((address >= 0xE000) && (address < 0xFE00))
-	{
-		// duplicate from ext RAM
-		return readMemory(address - 0x2000);
-	}
-	// TODO - more for 0xFF00 to fix input
-
-	/* ------ CPU ADDRESSES ------ */
-	else
-	{
-		return cpu[address];
-	}
-}
-
-void writeMemory(WORD address, BYTE data)
-{
-	/* ------ MEMORY BANK CONTROLLER ADDRESSES ------ */
-
-	/*
-		Register 0	(RAMCS gate data - serves as write-protection for RAM):
-		Write Area: 0x0000 - 0x1FFF
-		Write Data: 0x0A
-		Writing 0x0A to the write area causes the CS to be output, allowing access to RAM
-	*/
-	if ((address >= 0x0000) && (address < 0x2000))
-	{
-		mMBC.register0 = (data & 0x0A);
-	}
-
-	/*
-		Register 1	(ROM bank code):
-		Write Area: 0x2000 - 0x3FFF
-		Write Data: 0x01 - 0x1F
-		Allows the ROM bank to be selected in 16 kb increments
-	*/
-	else if ((address >= 0x2000) && (address < 0x4000))
-	{
-		// A value of 0 is seen as a 1
-		if (data == 0x00)
-		{
-			data = 0x01;
-		}
-
-		if (data < 0x01 || data > 0x1F)
-		{
-			return;
-		}
-
-		mMBC.romBank &= 0xE0;	// clear the lower 5 bits of the rom bank
-		mMBC.romBank |= data;	// set the lower 5 bits of the rom bank
-	}
-
-	/*
-		Register 2	(Upper ROM bank code when using 1 mb or more of ROM and register 3 is 0):
-		Write Area: 0x4000 - 0x5FFF
-		Write Data: 0x00 - 0x03
-		The upper ROM banks can be selected in 512 kb increments:
-			0 - banks 0x01 - 0x1f
-			1 - banks 0x21 - 0x3F
-			2 - banks 0x41 - 0x5F
-			3 - banks 0x61 - 0x7F
-
-		Register 2	(Upper ROM bank code when using 1 mb or more of ROM and register 3 is 1):
-		Write Area: 0x4000 - 0x5FFF
-		Write Data: 0x00 - 0x03
-		The RAM bank can be selected in 8 kb increments.
-	*/
-
-	else if ((address >= 0x4000) && (address < 0x6000))
-	{
-		if (!mMBC.register3)
-		{
-			mMBC.romBank &= 0x1F;	// Clear the upper bits of the rom bank
-			mMBC.romBank |= data << 5;
-		}
-		else
-		{
-			if (data > 0x03)
-			{
-				return;
-			}
-
-			mMBC.ramBank = data;
-		}
-	}
-
-	/*
-		Register 3	(ROM / RAM change)
-		Write Area: 0x6000 - 0x7FFF
-		Write Data: 0x00 - 0x01
-		Writing 0 causes register 2 output to control switching the higher ROM bank
-		Writing 1 causes register 2 output to control switching of the RAM bank
-	*/
-
-	else if ((address >= 0x6000) && (address < 0x8000))
-	{
-		mMBC.register3 = data;
-	}
-
-
-	/* ------ REGULAR ADDRESSES ------ */
-
-	// Read only memory areas
-	else if ((address >= 0xFEA0) && (address < 0xFEFF))
-	{
-		return;
-	}
-
-	// switchable RAM addresses
-	else if ((address >= 0xA000) && (address < 0xC000))
-	{
-		unsigned long targetAddress = address - 0xA000;
-		unsigned long ramAddress = (mMBC.ramBank * RAM_BANK_SIZE) + targetAddress;
-
-		mExtRAM[ramAddress] = data;
-	}
-	// TODO 0x8000 - 0x9FFF can only be accessed when FF41 is set to the correct mode
-	// 0xE000 - 0xFE00 also writes to RAM
-	else if ((address >= 0xE000) && (address < 0xFE00))
-	{
-		// Write to memory
-		cpu[address] = data;
-		// duplicate to regular RAM
-		writeMemory(address - 0x2000, data);
-	}
-	// TODO 0xFE00 - 0xFE9F can only be accessed when FF41 is set to the correct mode
-	// Scanline resets if written to
-	else if (address == 0xFF44)
-	{
-		cpu[address] = 0;
-	}
-	// OAM
-	else if (address == 0xFF46)
-	{
-		// Writing to FF46 (DMA register) initiates a transfer from RAM to OAM
-		WORD from = data << 8;
-
-		int i;
-		WORD oamAddress;
-		WORD ramAddress;
-
-		for (i = 0; i < SCREEN_WIDTH; i++)
-		{
-			oamAddress = 0xFE00 + i;
-			ramAddress = from + i;
-
-			cpu[oamAddress] = cpu[ramAddress];
-
-			// TODO writeMemory(oamAddress, readMemory(ramAddress));
-		}
-	}
-	// Timers
-	else if (address == 0xFF04)
-	{
-		// Writing to the divider register resets it
-		cpu[address] = 0;
-	}
-	else if (address == 0xFF07)
-	{
-		BYTE curFreq = getFrequency();
-		cpu[address] = data;
-		BYTE newFreq = getFrequency();
-		if (curFreq != newFreq)
-		{
-			setFrequency();
-		}
-	}
-	// Interrupts
-	else if (address == 0xFF0F)
-	{
-		cpu[address] = data;
-		interrupt.flags = data;
-	}
-	else if (address == 0xFFFF)
-	{
-		cpu[address] = data;
-		interrupt.enable = data;
-	}
-	// No other special areas, just write the data
-	else
-	{
-		cpu[address] = data;
-	}
-}
-
-void pushStack(WORD immediate)
-{
-	BYTE msb = (immediate >> 8) & 0xFF;
-	BYTE lsb = immediate & 0xFF;
-	/*
-		------------------
-		SP		0000
-		SP -1	lsb
-		SP -2	msb		-- new SP
-		------------------
-	*/
-	writeMemory(--SP.pair, lsb);
-	writeMemory(--SP.pair, msb);
-}
-
-WORD popStack()
-{
-	BYTE msb;
-	BYTE lsb;
-
-	/*
-	------------------
-	SP +2	0000	-- new SP
-	SP +1	lsb
-	SP		msb
-	------------------
-	*/
-	msb = readMemory(SP.pair++);
-	lsb = readMemory(SP.pair++);
-
-	WORD value = (msb << 8) | lsb;
-
-	return value;
+#include "hardware.h"
+#include "memory.h"
+#include "cartridge.h"
+#include "timers.h"
+#include "interrupts.h"
+#include "blockcache.h"
+#include "io.h"
+#include "gpu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ATOMIC_INCREMENT(value) _InterlockedIncrement(value)
+#define ATOMIC_DECREMENT(value) _InterlockedDecrement(value)
+#else
+#define ATOMIC_INCREMENT(value) __sync_add_and_fetch(value, 1)
+#define ATOMIC_DECREMENT(value) __sync_sub_and_fetch(value, 1)
+#endif
+
+#include "context.h"
+
+/*
+	Every 256 byte page of the address space has a pointer to the memory behind it for reading and one
+	for writing, so most accesses are a single load or store. Pages that need more than that on a write
+	have no write pointer and go through the checks in writeMemory: the MBC registers, VRAM, echo RAM,
+	OAM and the I/O ports, RAM that holds decoded code and RAM shared with another instance. The pointers
+	only change when a bank is switched, when code in RAM is decoded or overwritten, when a chunk is
+	shared or copied, or when a page is written for the first time since the dirty pages were cleared.
+*/
+
+// ROM banks past the end of the largest cartridge wrap around instead of reading past mCartridge
+#define ROM_BANKS (MAX_CARTRIDGE_SIZE / ROM_BANK_SIZE)
+
+/* ------ SHARED CHUNKS ------ */
+
+// Where a chunk is in this instance's own memory and extRAM
+BYTE *privateChunkBytes(int chunk)
+{
+	if (chunk < MEMORY_CHUNKS)
+	{
+		return &cpu[chunk * CHUNK_SIZE];
+	}
+
+	return &mExtRAM[(chunk - MEMORY_CHUNKS) * CHUNK_SIZE];
+}
+
+// Where the bytes of a chunk are for this instance right now
+BYTE *chunkBytes(int chunk)
+{
+	return mBorrowedChunks[chunk] ? mSharedChunks[chunk]->bytes : privateChunkBytes(chunk);
+}
+
+BYTE *memoryAt(WORD address)
+{
+	return chunkBytes(MEMORY_CHUNK(address)) + (address % CHUNK_SIZE);
+}
+
+BYTE *extRAMAt(unsigned int offset)
+{
+	return chunkBytes(EXT_RAM_CHUNK(offset)) + (offset % CHUNK_SIZE);
+}
+
+// Lets go of a shared chunk without copying it. Whoever lets go last frees it
+void releaseChunk(int chunk)
+{
+	sharedChunk *shared = mSharedChunks[chunk];
+
+	if (shared && (ATOMIC_DECREMENT(&shared->references) == 0))
+	{
+		free(shared);
+	}
+
+	mSharedChunks[chunk] = NULL;
+	mBorrowedChunks[chunk] = 0;
+}
+
+// Stops sharing a chunk, copying it into this instance's own memory first if it isn't there yet
+void ownChunk(int chunk)
+{
+	int page;
+
+	if (!mSharedChunks[chunk])
+	{
+		return;
+	}
+
+	if (mBorrowedChunks[chunk])
+	{
+		memcpy(privateChunkBytes(chunk), mSharedChunks[chunk]->bytes, CHUNK_SIZE);
+	}
+
+	releaseChunk(chunk);
+
+	if (chunk >= MEMORY_CHUNKS)
+	{
+		mapBanks();
+		return;
+	}
+
+	for (page = chunk * (CHUNK_SIZE >> 8); page < (chunk + 1) * (CHUNK_SIZE >> 8); page++)
+	{
+		mapPage((BYTE)page);
+
+		// Work RAM shows up again in echo RAM
+		if ((page >= 0xC0) && (page < 0xDE))
+		{
+			mapPage((BYTE)(page + 0x20));
+		}
+	}
+}
+
+void ownMemory()
+{
+	int chunk;
+
+	for (chunk = 0; chunk < CHUNKS; chunk++)
+	{
+		ownChunk(chunk);
+	}
+}
+
+// Lets go of every shared chunk, for when all of memory is about to be overwritten or thrown away. Doesn't map memory again
+void releaseChunks()
+{
+	int chunk;
+
+	for (chunk = 0; chunk < CHUNKS; chunk++)
+	{
+		releaseChunk(chunk);
+	}
+}
+
+/*
+	Returns a shared copy of a chunk with a reference taken for the caller, making one from this instance's
+	own bytes if there isn't one yet. This instance's writes to the chunk have to be caught from then on,
+	so memory has to be mapped again. Returns NULL when there isn't enough memory.
+*/
+sharedChunk *shareChunk(int chunk)
+{
+	sharedChunk *shared = mSharedChunks[chunk];
+
+	if (!shared)
+	{
+		shared = (sharedChunk*)malloc(sizeof(sharedChunk));
+		if (!shared)
+		{
+			return NULL;
+		}
+
+		shared->references = 1;
+		memcpy(shared->bytes, privateChunkBytes(chunk), CHUNK_SIZE);
+		mSharedChunks[chunk] = shared;
+	}
+
+	ATOMIC_INCREMENT(&shared->references);
+	return shared;
+}
+
+/* ------ DIRTY PAGES ------ */
+
+// Starts or stops keeping the dirty pages, either way every page starts out clean
+void trackDirtyPages(int track)
+{
+	mTrackDirtyPages = track;
+	memset(mDirtyPages, 0, sizeof(mDirtyPages));
+	mapMemory();
+}
+
+// Marks every page clean again. Only the pages that were dirty lose their write pointers
+void clearDirtyPages()
+{
+	int page;
+	int extRAM = 0;
+
+	for (page = 0; page < DIRTY_PAGES; page++)
+	{
+		if (!IS_DIRTY_PAGE(page))
+		{
+			continue;
+		}
+
+		mDirtyPages[page >> 3] &= ~(1 << (page & 7));
+
+		if (page < MEMORY_PAGES)
+		{
+			mapPage((BYTE)page);
+		}
+		else
+		{
+			extRAM = 1;
+		}
+	}
+
+	if (extRAM)
+	{
+		mapBanks();
+	}
+}
+
+/* ------ MEMORY MAP ------ */
+
+void mapPage(BYTE page)
+{
+	WORD address = page << 8;
+	BYTE *read;
+	BYTE *write = NULL;
+	int backing = -1;	// the page of cpu[] or mExtRAM writes go to, see DIRTY_PAGES
+
+	// Address 0x0000 to 0x3FFF is always ROM Bank #0
+	if (address < 0x4000)
+	{
+		read = &mCartridge[address];
+	}
+	// Address 0x4000 - 0x7FFF is the switchable ROM bank
+	else if (address < 0x8000)
+	{
+		read = &mCartridge[((mMBC.romBank % ROM_BANKS) * ROM_BANK_SIZE) + (address - 0x4000)];
+	}
+	// The gpu has to catch up before VRAM changes
+	else if (address < 0xA000)
+	{
+		read = memoryAt(address);
+	}
+	else if ((address >= 0xA000) && (address < 0xC000))
+	{
+		unsigned int offset = (mMBC.ramBank * RAM_BANK_SIZE) + (address - 0xA000);
+
+		read = write = extRAMAt(offset);
+		backing = MEMORY_PAGES + (offset >> 8);
+	}
+	else if ((address >= 0xE000) && (address < 0xFE00))
+	{
+		// duplicate from ext RAM, writes go to both copies
+		read = memoryAt(address - 0x2000);
+	}
+	// The I/O ports have handlers
+	else if (address >= 0xFF00)
+	{
+		read = NULL;
+	}
+	else
+	{
+		read = memoryAt(address);
+
+		if (address < 0xFE00)
+		{
+			write = read;
+			backing = page;
+		}
+	}
+
+	// Writes to decoded code have to reach invalidateCode, writes to a shared chunk have to copy it first and
+	// the first write to a clean page has to mark it dirty
+	if (write && (isCodePage(page) || mSharedChunks[PAGE_CHUNK(backing)] || (mTrackDirtyPages && !IS_DIRTY_PAGE(backing))))
+	{
+		write = NULL;
+	}
+
+	mReadPages[page] = read;
+	mWritePages[page] = write;
+}
+
+// Called when the MBC switches the ROM or RAM bank
+void mapBanks()
+{
+	int page;
+
+	for (page = 0x40; page < 0x80; page++)
+	{
+		mapPage((BYTE)page);
+	}
+
+	for (page = 0xA0; page < 0xC0; page++)
+	{
+		mapPage((BYTE)page);
+	}
+}
+
+void mapMemory()
+{
+	int page;
+
+	for (page = 0; page < 0x100; page++)
+	{
+		mapPage((BYTE)page);
+	}
+}
+
+BYTE readMemory(WORD address)
+{
+	BYTE *page = mReadPages[address >> 8];
+
+	if (page)
+	{
+		return page[address & 0xFF];
+	}
+
+	return readIO(address);
+}
+
+void writeMemory(WORD address, BYTE data)
+{
+	BYTE *page = mWritePages[address >> 8];
+
+	if (page)
+	{
+		page[address & 0xFF] = data;
+		return;
+	}
+
+	if (address >= 0x8000)
+	{
+		int backing = ((address >= 0xA000) && (address < 0xC000)) ?
+			MEMORY_PAGES + (((mMBC.ramBank * RAM_BANK_SIZE) + (address - 0xA000)) >> 8) : (address >> 8);
+
+		// The first write to a chunk shared with another instance gets this one its own copy of it
+		if (mSharedChunks[PAGE_CHUNK(backing)])
+		{
+			ownChunk(PAGE_CHUNK(backing));
+		}
+
+		// The first write to a clean page marks it, plain stores can take care of it from then on
+		if (mTrackDirtyPages && !IS_DIRTY_PAGE(backing))
+		{
+			MARK_DIRTY_PAGE(backing);
+			mapPage((BYTE)(address >> 8));
+		}
+	}
+
+	// Code that was decoded into a block is being overwritten or a different bank is being switched in
+	if ((address < 0x8000) || IS_CODE_BYTE(address))
+	{
+		invalidateCode(address);
+	}
+
+	/* ------ MEMORY BANK CONTROLLER ADDRESSES ------ */
+
+	/*
+		Register 0	(RAMCS gate data - serves as write-protection for RAM):
+		Write Area: 0x0000 - 0x1FFF
+		Write Data: 0x0A
+		Writing 0x0A to the write area causes the CS to be output, allowing access to RAM
+	*/
+	if ((address >= 0x0000) && (address < 0x2000))
+	{
+		mMBC.register0 = (data & 0x0A);
+	}
+
+	/*
+		Register 1	(ROM bank code):
+		Write Area: 0x2000 - 0x3FFF
+		Write Data: 0x01 - 0x1F
+		Allows the ROM bank to be selected in 16 kb increments
+	*/
+	else if ((address >= 0x2000) && (address < 0x4000))
+	{
+		// A value of 0 is seen as a 1
+		if (data == 0x00)
+		{
+			data = 0x01;
+		}
+
+		if (data < 0x01 || data > 0x1F)
+		{
+			return;
+		}
+
+		mMBC.romBank &= 0xE0;	// clear the lower 5 bits of the rom bank
+		mMBC.romBank |= data;	// set the lower 5 bits of the rom bank
+
+		mapBanks();
+	}
+
+	/*
+		Register 2	(Upper ROM bank code when using 1 mb or more of ROM and register 3 is 0):
+		Write Area: 0x4000 - 0x5FFF
+		Write Data: 0x00 - 0x03
+		The upper ROM banks can be selected in 512 kb increments:
+			0 - banks 0x01 - 0x1f
+			1 - banks 0x21 - 0x3F
+			2 - banks 0x41 - 0x5F
+			3 - banks 0x61 - 0x7F
+
+		Register 2	(Upper ROM bank code when using 1 mb or more of ROM and register 3 is 1):
+		Write Area: 0x4000 - 0x5FFF
+		Write Data: 0x00 - 0x03
+		The RAM bank can be selected in 8 kb increments.
+	*/
+
+	else if ((address >= 0x4000) && (address < 0x6000))
+	{
+		if (!mMBC.register3)
+		{
+			mMBC.romBank &= 0x1F;	// Clear the upper bits of the rom bank
+			mMBC.romBank |= data << 5;
+		}
+		else
+		{
+			if (data > 0x03)
+			{
+				return;
+			}
+
+			mMBC.ramBank = data;
+		}
+
+		mapBanks();
+	}
+
+	/*
+		Register 3	(ROM / RAM change)
+		Write Area: 0x6000 - 0x7FFF
+		Write Data: 0x00 - 0x01
+		Writing 0 causes register 2 output to control switching the higher ROM bank
+		Writing 1 causes register 2 output to control switching of the RAM bank
+	*/
+
+	else if ((address >= 0x6000) && (address < 0x8000))
+	{
+		mMBC.register3 = data;
+	}
+
+
+	/* ------ REGULAR ADDRESSES ------ */
+
+	// Read only memory areas
+	else if ((address >= 0xFEA0) && (address < 0xFEFF))
+	{
+		return;
+	}
+
+	// switchable RAM addresses
+	else if ((address >= 0xA000) && (address < 0xC000))
+	{
+		unsigned long targetAddress = address - 0xA000;
+		unsigned long ramAddress = (mMBC.ramBank * RAM_BANK_SIZE) + targetAddress;
+
+		mExtRAM[ramAddress] = data;
+	}
+	// TODO 0x8000 - 0x9FFF can only be accessed when FF41 is set to the correct mode
+	else if (address < 0xA000)
+	{
+		GPU_CATCH_UP();
+		cpu[address] = data;
+	}
+	// 0xE000 - 0xFE00 also writes to RAM
+	else if ((address >= 0xE000) && (address < 0xFE00))
+	{
+		// Write to memory
+		cpu[address] = data;
+		// duplicate to regular RAM
+		writeMemory(address - 0x2000, data);
+	}
+	// TODO 0xFE00 - 0xFE9F can only be accessed when FF41 is set to the correct mode
+	else if ((address >= 0xFE00) && (address < 0xFEA0))
+	{
+		GPU_CATCH_UP();
+		cpu[address] = data;
+	}
+	// I/O ports, HRAM and IE
+	else if (address >= 0xFF00)
+	{
+		writeIO(address, data);
+	}
+	// No other special areas, just write the data
+	else
+	{
+		cpu[address] = data;
+	}
+}
+
+// Writing to FF46 (DMA register) initiates a transfer from RAM to OAM
+void transferOAM(BYTE data)
+{
+	WORD from = data << 8;
+	BYTE *source = memoryAt(from);
+
+	int i;
+	WORD oamAddress;
+
+	GPU_CATCH_UP();
+
+	for (i = 0; i < SCREEN_WIDTH; i++)
+	{
+		oamAddress = 0xFE00 + i;
+
+		cpu[oamAddress] = source[i];
+
+		// TODO writeMemory(oamAddress, readMemory(ramAddress));
+	}
+}
+
+void pushStack(WORD immediate)
+{
+	BYTE msb = (immediate >> 8) & 0xFF;
+	BYTE lsb = immediate & 0xFF;
+	/*
+		------------------
+		SP		0000
+		SP -1	lsb
+		SP -2	msb		-- new SP
+		------------------
+	*/
+	writeMemory(--SP.pair, lsb);
+	writeMemory(--SP.pair, msb);
+}
+
+WORD popStack()
+{
+	BYTE msb;
+	BYTE lsb;
+
+	/*
+	------------------
+	SP +2	0000	-- new SP
+	SP +1	lsb
+	SP		msb
+	------------------
+	*/
+	msb = readMemory(SP.pair++);
+	lsb = readMemory(SP.pair++);
+
+	WORD value = (msb << 8) | lsb;
+
+	return value;
 }
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "movie.h"
+#include "savestate.h"
+#include "cartridge.h"
+#include "cpu.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+
+// Inputs are kept in an array that doubles whenever it fills up
+#define FIRST_MOVIE_INPUTS 256
+
+// cpuRun takes an int, longer replays are run in steps of about a second
+#define LONGEST_REPLAY_STEP (60 * CYCLES_PER_FRAME)
+
+typedef struct
+{
+	CYCLES cycle;		// clock when the joypad changed
+	BYTE joypad;
+} movieInput;
+
+// What a movie file starts with, followed by the start state and the inputs
+typedef struct
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned long long romHash;
+	unsigned long long endHash;
+	CYCLES endCycle;
+	int inputCount;
+} movieHeader;
+
+struct movie
+{
+	movieHeader header;
+	saveState *start;
+	movieInput *inputs;
+	int capacity;
+
+	// Next input the replay gives the joypad
+	int next;
+};
+
+// FNV-1a, only ever compared with hashes made by this build
+unsigned long long hashBytes(const BYTE *bytes, size_t length)
+{
+	unsigned long long hash = 0xCBF29CE484222325ULL;
+	size_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+unsigned long long hashROM()
+{
+	return hashBytes(mCartridge, mCartridgeHeader.romSize);
+}
+
+// The whole state the instance is in, taken the same way as a snapshot. Returns 0 when there isn't enough memory
+unsigned long long hashState()
+{
+	saveState *state = (saveState*)calloc(1, sizeof(saveState));
+	unsigned long long hash;
+
+	if (!state)
+	{
+		return 0;
+	}
+
+	saveSnapshot(state);
+	hash = hashBytes((BYTE*)state, sizeof(saveState));
+	free(state);
+
+	return hash;
+}
+
+movie *createMovie()
+{
+	movie *created = (movie*)calloc(1, sizeof(movie));
+
+	if (!created)
+	{
+		return NULL;
+	}
+
+	created->start = (saveState*)calloc(1, sizeof(saveState));
+	if (!created->start)
+	{
+		free(created);
+		return NULL;
+	}
+
+	created->header.magic = MOVIE_MAGIC;
+	created->header.version = MOVIE_VERSION;
+
+	return created;
+}
+
+void destroyMovie(movie *destroyed)
+{
+	if (!destroyed)
+	{
+		return;
+	}
+
+	free(destroyed->start);
+	free(destroyed->inputs);
+	free(destroyed);
+}
+
+/* ------ RECORDING ------ */
+
+movie *recordMovie()
+{
+	movie *created = createMovie();
+
+	if (!created)
+	{
+		return NULL;
+	}
+
+	created->header.romHash = hashROM();
+	saveSnapshot(created->start);
+
+	return created;
+}
+
+// Returns 0 when there isn't enough memory to keep the input, the joypad is set either way
+int recordJoypad(movie *recording, BYTE joypad)
+{
+	movieInput *input;
+
+	if (joypad == getJoypad())
+	{
+		return 1;
+	}
+
+	setJoypad(joypad);
+
+	if (recording->header.inputCount == recording->capacity)
+	{
+		int capacity = recording->capacity ? recording->capacity * 2 : FIRST_MOVIE_INPUTS;
+		movieInput *inputs = (movieInput*)realloc(recording->inputs, capacity * sizeof(movieInput));
+
+		if (!inputs)
+		{
+			return 0;
+		}
+
+		recording->inputs = inputs;
+		recording->capacity = capacity;
+	}
+
+	input = &recording->inputs[recording->header.inputCount++];
+	memset(input, 0, sizeof(movieInput));
+	input->cycle = clock;
+	input->joypad = joypad;
+
+	return 1;
+}
+
+void endMovie(movie *recording)
+{
+	recording->header.endCycle = clock;
+	recording->header.endHash = hashState();
+}
+
+/* ------ FILES ------ */
+
+int writeMovie(movie *written, char *output)
+{
+	FILE *file;
+	int complete;
+
+	fopen_s(&file, output, "wb");
+	if (file == 0)
+	{
+		return 0;
+	}
+
+	complete = (fwrite(&written->header, sizeof(movieHeader), 1, file) == 1)
+		&& (fwrite(written->start, sizeof(saveState), 1, file) == 1)
+		&& (fwrite(written->inputs, sizeof(movieInput), written->header.inputCount, file) == (size_t)written->header.inputCount);
+	fclose(file);
+
+	return complete;
+}
+
+// Returns NULL when the file can't be read or isn't a movie this build wrote
+movie *readMovie(char *input)
+{
+	movie *read = createMovie();
+	FILE *file;
+	int complete;
+
+	if (!read)
+	{
+		return NULL;
+	}
+
+	fopen_s(&file, input, "rb");
+	if (file == 0)
+	{
+		destroyMovie(read);
+		return NULL;
+	}
+
+	complete = (fread(&read->header, sizeof(movieHeader), 1, file) == 1)
+		&& (read->header.magic == MOVIE_MAGIC) && (read->header.version == MOVIE_VERSION) && (read->header.inputCount >= 0)
+		&& (fread(read->start, sizeof(saveState), 1, file) == 1);
+
+	if (complete && read->header.inputCount)
+	{
+		read->capacity = read->header.inputCount;
+		read->inputs = (movieInput*)malloc(read->capacity * sizeof(movieInput));
+		complete = read->inputs
+			&& (fread(read->inputs, sizeof(movieInput), read->header.inputCount, file) == (size_t)read->header.inputCount);
+	}
+	fclose(file);
+
+	if (!complete)
+	{
+		destroyMovie(read);
+		return NULL;
+	}
+
+	return read;
+}
+
+/* ------ REPLAY ------ */
+
+int startReplay(movie *replayed)
+{
+	if (replayed->header.romHash != hashROM())
+	{
+		return 0;
+	}
+
+	replayed->next = 0;
+	return loadSnapshot(replayed->start);
+}
+
+int replayMovie(movie *replayed, int cycles)
+{
+	CYCLES start = clock;
+	CYCLES target = clock + cycles;
+
+	if (target > replayed->header.endCycle)
+	{
+		target = replayed->header.endCycle;
+	}
+
+	for (;;)
+	{
+		CYCLES until = target;
+
+		while ((replayed->next < replayed->header.inputCount) && (replayed->inputs[replayed->next].cycle <= clock))
+		{
+			setJoypad(replayed->inputs[replayed->next++].joypad);
+		}
+
+		if (clock >= target)
+		{
+			break;
+		}
+
+		if ((replayed->next < replayed->header.inputCount) && (replayed->inputs[replayed->next].cycle < until))
+		{
+			until = replayed->inputs[replayed->next].cycle;
+		}
+
+		// A stopped cpu waits for a button, when the movie has none left where it stopped it never goes on
+		if (!cpuRun((int)(until - clock)) && stopped
+			&& ((replayed->next == replayed->header.inputCount) || (replayed->inputs[replayed->next].cycle > clock)))
+		{
+			break;
+		}
+	}
+
+	return (int)(clock - start);
+}
+
+int playMovie(movie *replayed)
+{
+	if (!startReplay(replayed))
+	{
+		return 0;
+	}
+
+	while (replayMovie(replayed, LONGEST_REPLAY_STEP));
+
+	return replayMatches(replayed);
+}
+
+// Whether the instance is where the recording ended
+int replayMatches(movie *replayed)
+{
+	return (clock == replayed->header.endCycle) && (hashState() == replayed->header.endHash);
+}
+
+CYCLES movieLength(movie *measured)
+{
+	return measured->header.endCycle - measured->start->machine.cycles;
+}
+
+int movieInputs(movie *measured)
+{
+	return measured->header.inputCount;
+}
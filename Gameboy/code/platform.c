@@ -0,0 +1,56 @@
+#include "platform.h"
+#include "cpu.h"
+#include <stdarg.h>
+
+// Longest log line, longer ones are cut short
+#define LOG_LINE_SIZE 256
+
+platform mPlatform;
+
+void setPlatform(const platform *callbacks)
+{
+	mPlatform = *callbacks;
+}
+
+void platformLine(const float *colours, int line)
+{
+	if (mPlatform.line)
+	{
+		mPlatform.line(colours, line, mPlatform.user);
+	}
+}
+
+void platformFrame()
+{
+	if (mPlatform.frame)
+	{
+		mPlatform.frame(mPlatform.user);
+	}
+}
+
+void platformLog(const char *format, ...)
+{
+	char line[LOG_LINE_SIZE];
+	va_list arguments;
+
+	if (!mPlatform.log)
+	{
+		return;
+	}
+
+	va_start(arguments, format);
+	vsnprintf(line, sizeof(line), format, arguments);
+	va_end(arguments);
+
+	mPlatform.log(line, mPlatform.user);
+}
+
+int runFrame()
+{
+	if (mPlatform.input)
+	{
+		setJoypad(mPlatform.input(mPlatform.user));
+	}
+
+	return cpuRun(CYCLES_PER_FRAME);
+}
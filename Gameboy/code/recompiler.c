@@ -0,0 +1,437 @@
+#include "recompiler.h"
+#include "blockcache.h"
+#include "cartridge.h"
+#include "cpu.h"
+#include "platform.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "context.h"
+
+/*
+	RECOMPILE_CARTRIDGE walks the code of every bank the same way DEBUG_CARTRIDGE lists it, but instead of
+	going byte by byte it follows jumps, calls and restarts from the entry points so only reachable code is
+	found. Every block is written out as a C function that calls the opcode handlers directly. The file is
+	meant to be compiled into the emulator with RECOMPILED_CARTRIDGE defined, anything that wasn't found
+	ahead of time (code in RAM, jumps through HL into code nothing else reaches) still runs from the block cache.
+*/
+
+// Handler names for every opcode, in the same order as mOpcodes
+const char *mOpcodeNames[256] =
+{
+	"NOP", "LD_BC", "LD_BC_A", "INC_BC", "INC_B", "DEC_B", "LD_B", "RLCA",	// 0x00
+	"LD_04X_SP", "ADD_HL_BC", "LD_A_BC", "DEC_BC", "INC_C", "DEC_C", "LD_C", "RRCA",	// 0x08
+	"STOP", "LD_DE", "LD_DE_A", "INC_DE", "INC_D", "DEC_D", "LD_D", "RLA",	// 0x10
+	"JR", "ADD_HL_DE", "LD_A_DE", "DEC_DE", "INC_E", "DEC_E", "LD_E", "RRA",	// 0x18
+	"JR_NZ", "LD_HL_WORD", "LDI_HL_A", "INC_HL", "INC_H", "DEC_H", "LD_H", "DAA",	// 0x20
+	"JR_Z", "ADD_HL_HL", "LDI_A_HL", "DEC_HL", "INC_L", "DEC_L", "LD_L", "CPL",	// 0x28
+	"JR_NC", "LD_SP", "LDD_HL_A", "INC_SP", "INC_HL_P", "DEC_HL_P", "LD_HL_BYTE", "SCF",	// 0x30
+	"JR_C", "ADD_HL_SP", "LDD_A_HL", "DEC_SP", "INC_A", "DEC_A", "LD_A_BYTE", "CCF",	// 0x38
+	"LD_B_B", "LD_B_C", "LD_B_D", "LD_B_E", "LD_B_H", "LD_B_L", "LD_B_HL", "LD_B_A",	// 0x40
+	"LD_C_B", "LD_C_C", "LD_C_D", "LD_C_E", "LD_C_H", "LD_C_L", "LD_C_HL", "LD_C_A",	// 0x48
+	"LD_D_B", "LD_D_C", "LD_D_D", "LD_D_E", "LD_D_H", "LD_D_L", "LD_D_HL", "LD_D_A",	// 0x50
+	"LD_E_B", "LD_E_C", "LD_E_D", "LD_E_E", "LD_E_H", "LD_E_L", "LD_E_HL", "LD_E_A",	// 0x58
+	"LD_H_B", "LD_H_C", "LD_H_D", "LD_H_E", "LD_H_H", "LD_H_L", "LD_H_HL", "LD_H_A",	// 0x60
+	"LD_L_B", "LD_L_C", "LD_L_D", "LD_L_E", "LD_L_H", "LD_L_L", "LD_L_HL", "LD_L_A",	// 0x68
+	"LD_HL_B", "LD_HL_C", "LD_HL_D", "LD_HL_E", "LD_HL_H", "LD_HL_L", "HALT", "LD_HL_A",	// 0x70
+	"LD_A_B", "LD_A_C", "LD_A_D", "LD_A_E", "LD_A_H", "LD_A_L", "LD_A_HL", "LD_A_A",	// 0x78
+	"ADD_A_B", "ADD_A_C", "ADD_A_D", "ADD_A_E", "ADD_A_H", "ADD_A_L", "ADD_A_HL", "ADD_A",	// 0x80
+	"ADC_B", "ADC_C", "ADC_D", "ADC_E", "ADC_H", "ADC_L", "ADC_HL", "ADC_A",	// 0x88
+	"SUB_B", "SUB_C", "SUB_D", "SUB_E", "SUB_H", "SUB_L", "SUB_HL", "SUB_A",	// 0x90
+	"SBC_B", "SBC_C", "SBC_D", "SBC_E", "SBC_H", "SBC_L", "SBC_HL", "SBC_A",	// 0x98
+	"AND_B", "AND_C", "AND_D", "AND_E", "AND_H", "AND_L", "AND_HL", "AND_A",	// 0xa0
+	"XOR_B", "XOR_C", "XOR_D", "XOR_E", "XOR_H", "XOR_L", "XOR_HL", "XOR_A",	// 0xa8
+	"OR_B", "OR_C", "OR_D", "OR_E", "OR_H", "OR_L", "OR_HL", "OR_A",	// 0xb0
+	"CP_B", "CP_C", "CP_D", "CP_E", "CP_H", "CP_L", "CP_HL", "CP_A",	// 0xb8
+	"RET_NZ", "POP_BC", "JP_NZ", "JP", "CALL_NZ", "PUSH_BC", "ADD_BYTE", "RST_00",	// 0xc0
+	"RET_Z", "RET", "JP_Z", "CB", "CALL_Z", "CALL", "ADC_BYTE", "RST_08",	// 0xc8
+	"RET_NC", "POP_DE", "JP_NC", "NOP", "CALL_NC", "PUSH_DE", "SUB_BYTE", "RST_10",	// 0xd0
+	"RET_C", "RETI", "JP_C", "NOP", "CALL_C", "NOP", "SBC_BYTE", "RST_18",	// 0xd8
+	"LD_FF02X_A", "POP_HL", "LD_FFC_A", "NOP", "NOP", "PUSH_HL", "AND_BYTE", "RST_20",	// 0xe0
+	"ADD_SP", "JP_HL", "LD_04X_A", "NOP", "NOP", "NOP", "XOR_BYTE", "RST_28",	// 0xe8
+	"LD_A_FF02X", "POP_AF", "LD_A_FFC", "DI", "NOP", "PUSH_AF", "OR_BYTE", "RST_30",	// 0xf0
+	"LD_HL_SP02X", "LD_SP_HL", "LD_A_WORD", "EI", "NOP", "NOP", "CP_BYTE", "RST_38",	// 0xf8
+};
+
+// One bit for every address of bank 0 followed by every address of every switchable bank, set where a block starts
+BYTE mBlockStarts[(ROM_BANK_SIZE + MAX_CARTRIDGE_SIZE) / BITS_PER_BYTE];
+
+typedef struct
+{
+	WORD bank;
+	WORD address;
+} blockStart;
+
+blockStart mWorklist[MAX_RECOMPILED_BLOCKS];
+int mWorklistSize;
+int mBlockCount;
+int mBankCount;
+
+unsigned int blockStartIndex(WORD bank, WORD address)
+{
+	if (address < 0x4000)
+	{
+		return address;
+	}
+
+	return ROM_BANK_SIZE + (bank * ROM_BANK_SIZE) + (address - 0x4000);
+}
+
+// Reads a byte as if bank was switched in, the same mapping readMemory uses
+BYTE readBank(WORD bank, WORD address)
+{
+	if (address < 0x4000)
+	{
+		return mCartridge[address];
+	}
+
+	return mCartridge[(bank * ROM_BANK_SIZE) + (address - 0x4000)];
+}
+
+void addBlockStart(WORD bank, WORD address)
+{
+	if (address < 0x4000)
+	{
+		bank = 0;
+	}
+
+	unsigned int index = blockStartIndex(bank, address);
+
+	if ((mBlockStarts[index >> 3] & (1 << (index & 7))) || (mBlockCount >= MAX_RECOMPILED_BLOCKS))
+	{
+		return;
+	}
+
+	mBlockStarts[index >> 3] |= (1 << (index & 7));
+	mBlockCount++;
+
+	mWorklist[mWorklistSize].bank = bank;
+	mWorklist[mWorklistSize].address = address;
+	mWorklistSize++;
+}
+
+/*
+	A jump from bank 0 into 0x4000 - 0x7FFF could land in any bank, there is no way to tell which one is
+	switched in without running the code. Those targets are added for every bank, which costs some dead
+	code for banks that never get there but means nothing reachable is missed.
+*/
+void addTarget(WORD bank, WORD from, unsigned int target)
+{
+	WORD i;
+
+	if (target >= 0x8000)
+	{
+		return;
+	}
+
+	if ((target < 0x4000) || (from >= 0x4000))
+	{
+		addBlockStart(bank, (WORD)target);
+		return;
+	}
+
+	for (i = 0; i < mBankCount; i++)
+	{
+		addBlockStart(i, (WORD)target);
+	}
+}
+
+// Decodes the block at bank:address and queues every block it can go to next
+void walkBlock(WORD bank, WORD address)
+{
+	unsigned int areaEnd = (address < 0x4000) ? 0x4000 : 0x8000;
+	unsigned int pc = address;
+
+	while (1)
+	{
+		BYTE opcode = readBank(bank, (WORD)pc);
+		int length = 1 + mOpcodes[opcode].operands;
+		WORD operand = 0;
+
+		if (pc + length > areaEnd)
+		{
+			return;
+		}
+
+		if (length > 1)
+		{
+			operand = readBank(bank, (WORD)(pc + 1));
+		}
+		if (length > 2)
+		{
+			operand |= readBank(bank, (WORD)(pc + 2)) << 8;
+		}
+
+		pc += length;
+
+		switch (opcode)
+		{
+		// Jumps that are always taken
+		case 0xc3:
+			addTarget(bank, address, operand);
+			return;
+		case 0x18:
+			addTarget(bank, address, (WORD)(pc + (SIGNED_BYTE)operand));
+			return;
+
+		// Conditional jumps and calls, which also carry on with the next instruction
+		case 0xc2: case 0xca: case 0xd2: case 0xda:
+		case 0xc4: case 0xcc: case 0xcd: case 0xd4: case 0xdc:
+			addTarget(bank, address, operand);
+			addTarget(bank, address, pc);
+			return;
+		case 0x20: case 0x28: case 0x30: case 0x38:
+			addTarget(bank, address, (WORD)(pc + (SIGNED_BYTE)operand));
+			addTarget(bank, address, pc);
+			return;
+
+		// Restarts jump to a fixed address in bank 0
+		case 0xc7: case 0xcf: case 0xd7: case 0xdf: case 0xe7: case 0xef: case 0xf7: case 0xff:
+			addTarget(bank, address, opcode & 0x38);
+			addTarget(bank, address, pc);
+			return;
+
+		// Conditional returns fall through, the others go somewhere only known at run time
+		case 0xc0: case 0xc8: case 0xd0: case 0xd8:
+			addTarget(bank, address, pc);
+			return;
+		case 0xc9: case 0xd9: case 0xe9:
+			return;
+
+		default:
+			if (endsBlock(opcode))
+			{
+				addTarget(bank, address, pc);
+				return;
+			}
+		}
+	}
+}
+
+void writeHandlerCall(FILE *fp, BYTE opcode, WORD operand)
+{
+	switch (opcode)
+	{
+	case 0x18:	// JR
+	case 0xe8:	// ADD SP
+	case 0xf8:	// LD HL, SP + n
+		fprintf(fp, "%s((SIGNED_BYTE)0x%02X)", mOpcodeNames[opcode], operand);
+		return;
+	}
+
+	switch (mOpcodes[opcode].operands)
+	{
+	case 0:
+		fprintf(fp, "%s()", mOpcodeNames[opcode]);
+		break;
+	case 1:
+		fprintf(fp, "%s(0x%02X)", mOpcodeNames[opcode], operand);
+		break;
+	default:
+		fprintf(fp, "%s(0x%04X)", mOpcodeNames[opcode], operand);
+		break;
+	}
+}
+
+// Writes the block at bank:address as a function, stopping where walkBlock stopped decoding it
+void writeBlock(FILE *fp, WORD bank, WORD address)
+{
+	unsigned int areaEnd = (address < 0x4000) ? 0x4000 : 0x8000;
+	unsigned int pc = address;
+
+	fprintf(fp, "static void b%02X_%04X(CYCLES target)\n{\n\tunsigned int codeChanges = mCodeChanges;\n\n", bank, address);
+
+	while (1)
+	{
+		BYTE opcode = readBank(bank, (WORD)pc);
+		int length = 1 + mOpcodes[opcode].operands;
+		WORD operand = 0;
+
+		if (pc + length > areaEnd)
+		{
+			break;
+		}
+
+		if (length > 1)
+		{
+			operand = readBank(bank, (WORD)(pc + 1));
+		}
+		if (length > 2)
+		{
+			operand |= readBank(bank, (WORD)(pc + 2)) << 8;
+		}
+
+		pc += length;
+
+		fprintf(fp, "\tRECOMPILED_INSTRUCTION(0x%04X, 0x%04X, ", pc - 1, pc & 0xFFFF);
+		writeHandlerCall(fp, opcode, operand);
+		fprintf(fp, ")\n");
+
+		if (endsBlock(opcode))
+		{
+			break;
+		}
+	}
+
+	fprintf(fp, "}\n\n");
+}
+
+int isBlockStart(WORD bank, WORD address)
+{
+	unsigned int index = blockStartIndex(bank, address);
+
+	return mBlockStarts[index >> 3] & (1 << (index & 7));
+}
+
+/*
+	Writes the C translation of the loaded cartridge to output. Returns 0 if the file can't be written.
+	Only the ROM is looked at, nothing about the running emulator changes.
+*/
+int RECOMPILE_CARTRIDGE(char *output)
+{
+	FILE *fp;
+	WORD bank;
+	unsigned int address;
+	int i;
+
+	fopen_s(&fp, output, "w");
+	if (fp == 0)
+	{
+		return 0;
+	}
+
+	memset(mBlockStarts, 0, sizeof(mBlockStarts));
+	mWorklistSize = 0;
+	mBlockCount = 0;
+	mBankCount = mCartridgeHeader.romSize / ROM_BANK_SIZE;
+
+	// Power on, restarts and interrupt vectors
+	addBlockStart(0, 0x0100);
+	for (address = 0x00; address <= 0x60; address += 0x08)
+	{
+		addBlockStart(0, (WORD)address);
+	}
+
+	while (mWorklistSize > 0)
+	{
+		mWorklistSize--;
+		walkBlock(mWorklist[mWorklistSize].bank, mWorklist[mWorklistSize].address);
+	}
+
+	WORD checksum = (mCartridge[GLOBAL_CHECKSUM_BYTE] << 8) | mCartridge[GLOBAL_CHECKSUM_BYTE + 1];
+
+	// The title can hold anything on a bad cartridge, keep the comment to printable characters
+	fprintf(fp, "// Generated by RECOMPILE_CARTRIDGE for ");
+	for (i = 0; i < 16; i++)
+	{
+		if ((mCartridgeHeader.title[i] >= 0x20) && (mCartridgeHeader.title[i] < 0x7F))
+		{
+			fputc(mCartridgeHeader.title[i], fp);
+		}
+	}
+	fprintf(fp, ", %d blocks. Build with RECOMPILED_CARTRIDGE defined\n\n", mBlockCount);
+	fprintf(fp, "#include \"hardware.h\"\n#include \"context.h\"\n#include \"opcodes.h\"\n#include \"cpu.h\"\n#include \"blockcache.h\"\n#include \"recompiler.h\"\n\n");
+
+	// Bank 0 first, then every switchable bank, so the table comes out sorted
+	for (i = -1; i < mBankCount; i++)
+	{
+		unsigned int start = (i < 0) ? 0x0000 : 0x4000;
+
+		for (address = start; address < start + ROM_BANK_SIZE; address++)
+		{
+			bank = (i < 0) ? 0 : (WORD)i;
+
+			if (isBlockStart(bank, (WORD)address))
+			{
+				writeBlock(fp, bank, (WORD)address);
+			}
+		}
+	}
+
+	fprintf(fp, "const recompiledBlock mRecompiledBlocks[] =\n{\n");
+
+	for (i = -1; i < mBankCount; i++)
+	{
+		unsigned int start = (i < 0) ? 0x0000 : 0x4000;
+
+		for (address = start; address < start + ROM_BANK_SIZE; address++)
+		{
+			bank = (i < 0) ? 0 : (WORD)i;
+
+			if (isBlockStart(bank, (WORD)address))
+			{
+				fprintf(fp, "\t{ 0x%02X, 0x%04X, b%02X_%04X },\n", bank, address, bank, address);
+			}
+		}
+	}
+
+	fprintf(fp, "};\n\n");
+	fprintf(fp, "const int mRecompiledBlockCount = %d;\n", mBlockCount);
+	fprintf(fp, "const WORD mRecompiledChecksum = 0x%04X;\n", checksum);
+
+	fclose(fp);
+
+	return 1;
+}
+
+// Everything after the handler, kept out of line so the generated file doesn't get any bigger than it has to
+int finishRecompiledInstruction(WORD next, CYCLES target, unsigned int codeChanges)
+{
+	PC.pair++;
+	afterInstruction();
+
+	return (PC.pair != next) || halt || stopped || (clock >= target) || (mCodeChanges != codeChanges);
+}
+
+#ifdef RECOMPILED_CARTRIDGE
+
+recompiledFunction findRecompiledBlock(WORD bank, WORD address)
+{
+	int low = 0;
+	int high = mRecompiledBlockCount - 1;
+
+	while (low <= high)
+	{
+		int middle = (low + high) / 2;
+		const recompiledBlock *block = &mRecompiledBlocks[middle];
+
+		if ((block->bank == bank) && (block->address == address))
+		{
+			return block->function;
+		}
+
+		if ((block->bank < bank) || ((block->bank == bank) && (block->address < address)))
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	return NULL;
+}
+
+// Runs the recompiled block at PC, or goes through the block cache if there isn't one or a different cartridge is loaded
+void runRecompiled(CYCLES target)
+{
+	recompiledFunction function = NULL;
+	WORD checksum = (mCartridge[GLOBAL_CHECKSUM_BYTE] << 8) | mCartridge[GLOBAL_CHECKSUM_BYTE + 1];
+
+	if (!halt && !PRINT_LOGS && (PC.pair < 0x8000) && (checksum == mRecompiledChecksum))
+	{
+		function = findRecompiledBlock(blockBank(PC.pair), PC.pair);
+	}
+
+	if (function)
+	{
+		function(target);
+	}
+	else
+	{
+		runBlock(target);
+	}
+}
+
+#endif
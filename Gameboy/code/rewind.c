@@ -0,0 +1,517 @@
+#include "rewind.h"
+#include "savestate.h"
+#include "memory.h"
+#include "threads.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+
+// Deltas saved by the emulation thread that haven't been compressed yet, it waits once all of them are taken
+#define REWIND_QUEUE 4
+
+// A frame before compression is the machine XORed with the frame before it, the mask of pages in it and those
+// pages XORed with the frame before it
+#define RAW_FRAME_SIZE (sizeof(machineState) + DIRTY_PAGES / BITS_PER_BYTE + DIRTY_PAGES * 0x100)
+
+// Run length encoding adds at most a byte for every 128
+#define PACKED_FRAME_SIZE (RAW_FRAME_SIZE + RAW_FRAME_SIZE / 128 + 1)
+
+#define LONGEST_LITERALS	128
+#define SHORTEST_RUN		3
+#define LONGEST_RUN			130
+
+typedef struct
+{
+	size_t offset;
+	size_t length;
+} rewindFrame;
+
+struct rewinder
+{
+	GameBoy *instance;
+	threadHandle thread;
+
+	// The emulation thread saves into the queue and the rewinder's thread compresses from it. Everything below
+	// belongs to the rewinder's thread while pending isn't 0, rewinding waits on done until it is
+	threadLock lock;
+	threadCondition work;
+	threadCondition done;
+	deltaState *queue;
+	int first;
+	int pending;
+	int shutdown;
+
+	// The instance as it was at the newest frame
+	saveState *shadow;
+	int started;
+
+	// Frames are packed one after the other and start over at the beginning when the next one doesn't fit,
+	// so the oldest frame is always the first one from end on
+	BYTE *ring;
+	size_t ringSize;
+	size_t end;
+	size_t used;
+	rewindFrame *frames;	// frame n is at n % capacity
+	int capacity;
+	int count;
+	unsigned int newest;
+
+	BYTE *raw;
+	BYTE *packed;
+	deltaState *load;
+};
+
+BYTE *shadowPage(saveState *shadow, int page)
+{
+	return (page < MEMORY_PAGES) ? &shadow->memory[page << 8] : &shadow->extRAM[(page - MEMORY_PAGES) << 8];
+}
+
+/* ------ RUN LENGTH ENCODING ------ */
+
+/*
+	A control byte below 128 is followed by that many plus one bytes as they are, anything else by one byte
+	repeated the control byte minus 125 times. Most of a frame XORed with the one before is runs of zeroes.
+*/
+size_t packFrame(const BYTE *from, size_t length, BYTE *to)
+{
+	size_t read = 0;
+	size_t written = 0;
+
+	while (read < length)
+	{
+		size_t run = 1;
+		while ((read + run < length) && (run < LONGEST_RUN) && (from[read + run] == from[read]))
+		{
+			run++;
+		}
+
+		if (run >= SHORTEST_RUN)
+		{
+			to[written++] = (BYTE)(run + 125);
+			to[written++] = from[read];
+			read += run;
+		}
+		else
+		{
+			size_t start = read;
+			size_t literals = 0;
+
+			while ((read < length) && (literals < LONGEST_LITERALS)
+				&& !((read + 2 < length) && (from[read] == from[read + 1]) && (from[read] == from[read + 2])))
+			{
+				read++;
+				literals++;
+			}
+
+			to[written++] = (BYTE)(literals - 1);
+			memcpy(&to[written], &from[start], literals);
+			written += literals;
+		}
+	}
+
+	return written;
+}
+
+void unpackFrame(const BYTE *from, size_t length, BYTE *to)
+{
+	size_t read = 0;
+
+	while (read < length)
+	{
+		BYTE control = from[read++];
+
+		if (control < LONGEST_LITERALS)
+		{
+			memcpy(to, &from[read], control + 1);
+			read += control + 1;
+			to += control + 1;
+		}
+		else
+		{
+			memset(to, from[read++], control - 125);
+			to += control - 125;
+		}
+	}
+}
+
+/* ------ RING ------ */
+
+rewindFrame *oldestFrame(rewinder *owner)
+{
+	return &owner->frames[(owner->newest - owner->count + 1) % owner->capacity];
+}
+
+void dropOldestFrame(rewinder *owner)
+{
+	owner->used -= oldestFrame(owner)->length;
+	owner->count--;
+}
+
+// Makes room for a frame of the given length after the newest one, dropping as many of the oldest frames as it takes
+void storeFrame(rewinder *owner, size_t length)
+{
+	rewindFrame *frame;
+
+	if (owner->count == owner->capacity)
+	{
+		dropOldestFrame(owner);
+	}
+
+	// A frame bigger than the whole ring can't be kept, and nothing before it can be reached without it
+	if (length > owner->ringSize)
+	{
+		owner->count = 0;
+		owner->used = 0;
+		owner->end = 0;
+		owner->newest++;
+		return;
+	}
+
+	if (owner->end + length > owner->ringSize)
+	{
+		// The frames between end and the end of the ring are the oldest ones
+		while (owner->count && (oldestFrame(owner)->offset >= owner->end))
+		{
+			dropOldestFrame(owner);
+		}
+		owner->end = 0;
+	}
+
+	while (owner->count && (oldestFrame(owner)->offset >= owner->end) && (oldestFrame(owner)->offset < owner->end + length))
+	{
+		dropOldestFrame(owner);
+	}
+
+	owner->newest++;
+	owner->count++;
+	frame = &owner->frames[owner->newest % owner->capacity];
+	frame->offset = owner->end;
+	frame->length = length;
+	memcpy(&owner->ring[frame->offset], owner->packed, length);
+
+	owner->end += length;
+	owner->used += length;
+}
+
+void compressFrame(rewinder *owner, const deltaState *delta)
+{
+	BYTE *raw = owner->raw;
+	BYTE *shadow = (BYTE*)&owner->shadow->machine;
+	const BYTE *machine = (const BYTE*)&delta->machine;
+	size_t length = 0;
+	int count = 0;
+	size_t i;
+	int page;
+
+	for (i = 0; i < sizeof(machineState); i++)
+	{
+		raw[length++] = machine[i] ^ shadow[i];
+	}
+	memcpy(shadow, machine, sizeof(machineState));
+
+	memcpy(&raw[length], delta->pageMask, sizeof(delta->pageMask));
+	length += sizeof(delta->pageMask);
+
+	for (page = 0; page < DIRTY_PAGES; page++)
+	{
+		if (delta->pageMask[page >> 3] & (1 << (page & 7)))
+		{
+			const BYTE *data = delta->data[count++];
+
+			shadow = shadowPage(owner->shadow, page);
+			for (i = 0; i < 0x100; i++)
+			{
+				raw[length++] = data[i] ^ shadow[i];
+			}
+			memcpy(shadow, data, 0x100);
+		}
+	}
+
+	storeFrame(owner, packFrame(raw, length, owner->packed));
+}
+
+/* ------ THREAD ------ */
+
+THREAD_FUNCTION(rewindThread, argument)
+{
+	rewinder *owner = (rewinder*)argument;
+
+	LOCK(&owner->lock);
+	for (;;)
+	{
+		while (!owner->pending && !owner->shutdown)
+		{
+			WAIT(&owner->work, &owner->lock);
+		}
+
+		if (!owner->pending)
+		{
+			break;
+		}
+
+		UNLOCK(&owner->lock);
+		compressFrame(owner, &owner->queue[owner->first]);
+		LOCK(&owner->lock);
+
+		owner->first = (owner->first + 1) % REWIND_QUEUE;
+		owner->pending--;
+		WAKE_ALL(&owner->done);
+	}
+	UNLOCK(&owner->lock);
+
+	THREAD_RETURN;
+}
+
+// Takes the lock once every frame recorded so far is in the ring
+void waitForFrames(rewinder *owner)
+{
+	LOCK(&owner->lock);
+	while (owner->pending)
+	{
+		WAIT(&owner->done, &owner->lock);
+	}
+}
+
+/* ------ REWINDER ------ */
+
+rewinder *createRewinder(GameBoy *instance, int frames, size_t bytes)
+{
+	rewinder *created = (rewinder*)calloc(1, sizeof(rewinder));
+
+	if (!created)
+	{
+		return NULL;
+	}
+
+	created->instance = instance;
+	created->queue = (deltaState*)calloc(REWIND_QUEUE, sizeof(deltaState));
+	created->shadow = (saveState*)calloc(1, sizeof(saveState));
+	created->ring = (BYTE*)malloc(bytes);
+	created->ringSize = bytes;
+	created->frames = (rewindFrame*)calloc(frames, sizeof(rewindFrame));
+	created->capacity = frames;
+	created->raw = (BYTE*)malloc(RAW_FRAME_SIZE);
+	created->packed = (BYTE*)malloc(PACKED_FRAME_SIZE);
+	created->load = (deltaState*)malloc(sizeof(deltaState));
+
+	if (!created->queue || !created->shadow || !created->ring || !created->frames || !created->raw || !created->packed || !created->load)
+	{
+		free(created->queue);
+		free(created->shadow);
+		free(created->ring);
+		free(created->frames);
+		free(created->raw);
+		free(created->packed);
+		free(created->load);
+		free(created);
+		return NULL;
+	}
+
+	INITIALIZE_LOCK(&created->lock);
+	INITIALIZE_CONDITION(&created->work);
+	INITIALIZE_CONDITION(&created->done);
+	START_THREAD(created->thread, rewindThread, created);
+
+	return created;
+}
+
+void destroyRewinder(rewinder *destroyed)
+{
+	GameBoy *current = gb;
+
+	if (!destroyed)
+	{
+		return;
+	}
+
+	LOCK(&destroyed->lock);
+	destroyed->shutdown = 1;
+	WAKE_ALL(&destroyed->work);
+	UNLOCK(&destroyed->lock);
+
+	JOIN_THREAD(destroyed->thread);
+	DESTROY_CONDITION(&destroyed->done);
+	DESTROY_CONDITION(&destroyed->work);
+	DESTROY_LOCK(&destroyed->lock);
+
+	if (destroyed->started)
+	{
+		selectGameBoy(destroyed->instance);
+		trackDirtyPages(0);
+		selectGameBoy(current);
+	}
+
+	free(destroyed->queue);
+	free(destroyed->shadow);
+	free(destroyed->ring);
+	free(destroyed->frames);
+	free(destroyed->raw);
+	free(destroyed->packed);
+	free(destroyed->load);
+	free(destroyed);
+}
+
+void recordRewindFrame(rewinder *owner)
+{
+	GameBoy *current = gb;
+	deltaState *delta;
+
+	selectGameBoy(owner->instance);
+
+	// Nothing is queued before the first frame, the shadow is still the emulation thread's
+	if (!owner->started)
+	{
+		saveKeyframe(owner->shadow);
+		owner->started = 1;
+		selectGameBoy(current);
+		return;
+	}
+
+	LOCK(&owner->lock);
+	while (owner->pending == REWIND_QUEUE)
+	{
+		WAIT(&owner->done, &owner->lock);
+	}
+	delta = &owner->queue[(owner->first + owner->pending) % REWIND_QUEUE];
+	UNLOCK(&owner->lock);
+
+	// The slot isn't pending yet so the rewinder's thread leaves it alone
+	saveDelta(delta);
+
+	LOCK(&owner->lock);
+	owner->pending++;
+	WAKE_ALL(&owner->work);
+	UNLOCK(&owner->lock);
+
+	selectGameBoy(current);
+}
+
+/*
+	Undoes the newest frames one at a time on the shadow, then loads every page they touched and every page the
+	instance wrote since the newest frame from the shadow, as one delta.
+*/
+int rewindToFrame(rewinder *owner, unsigned int frame)
+{
+	GameBoy *current = gb;
+	deltaState *load = owner->load;
+	size_t i;
+	int page;
+
+	waitForFrames(owner);
+
+	if (!owner->started || (frame > owner->newest) || (frame < owner->newest - owner->count))
+	{
+		UNLOCK(&owner->lock);
+		return 0;
+	}
+
+	memset(load->pageMask, 0, sizeof(load->pageMask));
+
+	while (owner->newest != frame)
+	{
+		rewindFrame *newest = &owner->frames[owner->newest % owner->capacity];
+		BYTE *raw = owner->raw;
+		BYTE *shadow = (BYTE*)&owner->shadow->machine;
+		const BYTE *mask;
+
+		unpackFrame(&owner->ring[newest->offset], newest->length, raw);
+
+		for (i = 0; i < sizeof(machineState); i++)
+		{
+			shadow[i] ^= *raw++;
+		}
+
+		mask = raw;
+		raw += sizeof(load->pageMask);
+		for (page = 0; page < DIRTY_PAGES; page++)
+		{
+			if (mask[page >> 3] & (1 << (page & 7)))
+			{
+				shadow = shadowPage(owner->shadow, page);
+				for (i = 0; i < 0x100; i++)
+				{
+					shadow[i] ^= *raw++;
+				}
+			}
+		}
+
+		for (i = 0; i < sizeof(load->pageMask); i++)
+		{
+			load->pageMask[i] |= mask[i];
+		}
+
+		owner->end = newest->offset;
+		owner->used -= newest->length;
+		owner->count--;
+		owner->newest--;
+	}
+
+	selectGameBoy(owner->instance);
+
+	// The hardware writes OAM and the I/O ports without marking them
+	MARK_DIRTY_PAGE(0xFE);
+	MARK_DIRTY_PAGE(0xFF);
+
+	load->pageCount = 0;
+	for (page = 0; page < DIRTY_PAGES; page++)
+	{
+		if (IS_DIRTY_PAGE(page))
+		{
+			load->pageMask[page >> 3] |= 1 << (page & 7);
+		}
+
+		if (load->pageMask[page >> 3] & (1 << (page & 7)))
+		{
+			memcpy(load->data[load->pageCount++], shadowPage(owner->shadow, page), sizeof(load->data[0]));
+		}
+	}
+
+	memcpy(&load->machine, &owner->shadow->machine, sizeof(machineState));
+	load->machine.size = sizeof(deltaState);
+	loadDelta(load);
+
+	selectGameBoy(current);
+	UNLOCK(&owner->lock);
+
+	return 1;
+}
+
+int stepBack(rewinder *owner)
+{
+	unsigned int newest = newestRewindFrame(owner);
+	return newest && rewindToFrame(owner, newest - 1);
+}
+
+unsigned int newestRewindFrame(rewinder *owner)
+{
+	unsigned int newest;
+
+	waitForFrames(owner);
+	newest = owner->newest;
+	UNLOCK(&owner->lock);
+
+	return newest;
+}
+
+unsigned int oldestRewindFrame(rewinder *owner)
+{
+	unsigned int oldest;
+
+	waitForFrames(owner);
+	oldest = owner->newest - owner->count;
+	UNLOCK(&owner->lock);
+
+	return oldest;
+}
+
+size_t rewindBytes(rewinder *owner)
+{
+	size_t used;
+
+	waitForFrames(owner);
+	used = owner->used;
+	UNLOCK(&owner->lock);
+
+	return used;
+}
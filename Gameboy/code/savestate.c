@@ -0,0 +1,283 @@
+#include "savestate.h"
+#include "blockcache.h"
+#include "memory.h"
+#include "gpu.h"
+#include "lazyflags.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "context.h"
+
+// The callback every event type is always scheduled with
+const eventCallback mEventCallbacks[EVENT_COUNT] =
+{
+	gpuEvent,
+	timerStep,
+	interruptStep,
+};
+
+void saveMachine(machineState *machine, unsigned int size)
+{
+	int i;
+
+	RESOLVE_FLAGS();
+
+	machine->magic = SAVE_STATE_MAGIC;
+	machine->version = SAVE_STATE_VERSION;
+	machine->size = size;
+	memcpy(machine->title, mCartridgeHeader.title, sizeof(machine->title));
+
+	machine->af = registerAF;
+	machine->bc = registerBC;
+	machine->de = registerDE;
+	machine->hl = registerHL;
+	machine->sp = SP;
+	machine->pc = PC;
+	machine->interrupts = interrupt;
+	machine->cycles = clock;
+	machine->halted = halt;
+	machine->isStopped = stopped;
+
+	for (i = 0; i < EVENT_COUNT; i++)
+	{
+		machine->eventScheduled[i] = (BYTE)isEventScheduled((eventType)i);
+		machine->eventCycles[i] = machine->eventScheduled[i] ? eventCycle((eventType)i) : 0;
+	}
+
+	machine->gpuMode = mMode;
+	machine->gpuLine = mLine;
+	machine->gpuModeEnd = mGpuModeEnd;
+	machine->timers = mTimer;
+	machine->joypad = keys;
+	machine->mbc = mMBC;
+}
+
+int isMachineLoadable(const machineState *machine, unsigned int size)
+{
+	return (machine->magic == SAVE_STATE_MAGIC) && (machine->version == SAVE_STATE_VERSION) && (machine->size == size)
+		&& !memcmp(machine->title, mCartridgeHeader.title, sizeof(machine->title));
+}
+
+// Memory has to be loaded before, the memory map is made again for the banks the machine has
+void loadMachine(const machineState *machine)
+{
+	int i;
+
+	registerAF = machine->af;
+	registerBC = machine->bc;
+	registerDE = machine->de;
+	registerHL = machine->hl;
+	SP = machine->sp;
+	PC = machine->pc;
+	interrupt = machine->interrupts;
+	clock = machine->cycles;
+	halt = machine->halted;
+	stopped = machine->isStopped;
+	mLazyFlags.operation = LAZY_NONE;
+
+	// Events that are due on the same cycle run in the order of their type, so the heap doesn't have to look the same
+	initializeScheduler();
+	for (i = 0; i < EVENT_COUNT; i++)
+	{
+		if (machine->eventScheduled[i])
+		{
+			scheduleEvent((eventType)i, machine->eventCycles[i], mEventCallbacks[i]);
+		}
+	}
+
+	mMode = machine->gpuMode;
+	mLine = machine->gpuLine;
+	mGpuModeEnd = machine->gpuModeEnd;
+	mTimer = machine->timers;
+	keys = machine->joypad;
+	mMBC = machine->mbc;
+
+	// What was loaded is where the next delta starts from
+	if (mTrackDirtyPages)
+	{
+		memset(mDirtyPages, 0, sizeof(mDirtyPages));
+	}
+
+	mCodeChanges++;
+	mapMemory();
+}
+
+// Code decoded from a page of cpu[] that was overwritten can be different now. Blocks from ROM are keyed by their bank and stay good
+void invalidatePage(int page)
+{
+	if ((page >= 0x80) && (page < MEMORY_PAGES))
+	{
+		mPageVersion[page]++;
+		memset(&mCodeBytes[page << 5], 0, 0x100 / BITS_PER_BYTE);
+	}
+}
+
+BYTE *pageBytes(int page)
+{
+	return chunkBytes(PAGE_CHUNK(page)) + ((page % (CHUNK_SIZE >> 8)) << 8);
+}
+
+void saveSnapshot(saveState *state)
+{
+	int i;
+
+	saveMachine(&state->machine, sizeof(saveState));
+
+	// Chunks shared with other instances aren't in cpu[] or mExtRAM
+	for (i = 0; i < CHUNKS; i++)
+	{
+		BYTE *to = (i < MEMORY_CHUNKS) ? &state->memory[i * CHUNK_SIZE] : &state->extRAM[(i - MEMORY_CHUNKS) * CHUNK_SIZE];
+		memcpy(to, chunkBytes(i), CHUNK_SIZE);
+	}
+}
+
+int loadSnapshot(const saveState *state)
+{
+	int page;
+
+	if (!isMachineLoadable(&state->machine, sizeof(saveState)))
+	{
+		return 0;
+	}
+
+	// Everything is overwritten, so chunks shared with other instances are let go without copying them
+	releaseChunks();
+	memcpy(cpu, state->memory, sizeof(state->memory));
+	memcpy(mExtRAM, state->extRAM, sizeof(state->extRAM));
+
+	for (page = 0x80; page < MEMORY_PAGES; page++)
+	{
+		invalidatePage(page);
+	}
+
+	loadMachine(&state->machine);
+
+	return 1;
+}
+
+void saveKeyframe(saveState *state)
+{
+	saveSnapshot(state);
+
+	if (mTrackDirtyPages)
+	{
+		clearDirtyPages();
+	}
+	else
+	{
+		trackDirtyPages(1);
+	}
+}
+
+int saveDelta(deltaState *delta)
+{
+	int page;
+
+	if (!mTrackDirtyPages)
+	{
+		return 0;
+	}
+
+	saveMachine(&delta->machine, sizeof(deltaState));
+	memset(delta->pageMask, 0, sizeof(delta->pageMask));
+	delta->pageCount = 0;
+
+	// The hardware writes OAM and the I/O ports without marking them
+	MARK_DIRTY_PAGE(0xFE);
+	MARK_DIRTY_PAGE(0xFF);
+
+	for (page = 0; page < DIRTY_PAGES; page++)
+	{
+		if (IS_DIRTY_PAGE(page))
+		{
+			delta->pageMask[page >> 3] |= 1 << (page & 7);
+			memcpy(delta->data[delta->pageCount++], pageBytes(page), sizeof(delta->data[0]));
+		}
+	}
+
+	clearDirtyPages();
+
+	return 1;
+}
+
+int loadDelta(const deltaState *delta)
+{
+	int page;
+	int count = 0;
+
+	if (!isMachineLoadable(&delta->machine, sizeof(deltaState)))
+	{
+		return 0;
+	}
+
+	for (page = 0; page < DIRTY_PAGES; page++)
+	{
+		if (delta->pageMask[page >> 3] & (1 << (page & 7)))
+		{
+			ownChunk(PAGE_CHUNK(page));
+			memcpy(pageBytes(page), delta->data[count++], sizeof(delta->data[0]));
+			invalidatePage(page);
+		}
+	}
+
+	loadMachine(&delta->machine);
+
+	return 1;
+}
+
+int writeSaveState(char *output)
+{
+	saveState *state = (saveState*)malloc(sizeof(saveState));
+	FILE *file;
+	size_t written;
+
+	if (!state)
+	{
+		return 0;
+	}
+
+	fopen_s(&file, output, "wb");
+	if (file == 0)
+	{
+		free(state);
+		return 0;
+	}
+
+	saveSnapshot(state);
+	written = fwrite(state, sizeof(saveState), 1, file);
+	fclose(file);
+	free(state);
+
+	return written == 1;
+}
+
+int readSaveState(char *input)
+{
+	saveState *state = (saveState*)malloc(sizeof(saveState));
+	FILE *file;
+	int loaded = 0;
+
+	if (!state)
+	{
+		return 0;
+	}
+
+	fopen_s(&file, input, "rb");
+	if (file == 0)
+	{
+		free(state);
+		return 0;
+	}
+
+	if (fread(state, sizeof(saveState), 1, file) == 1)
+	{
+		loaded = loadSnapshot(state);
+	}
+
+	fclose(file);
+	free(state);
+
+	return loaded;
+}
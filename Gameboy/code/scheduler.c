@@ -0,0 +1,156 @@
+#include "scheduler.h"
+#include "context.h"
+
+/*
+	The scheduler is a small binary min-heap of events ordered by the cycle they are due.
+	There is at most one pending event of each type so the heap never holds more than EVENT_COUNT entries,
+	and mHeapPosition lets an event be moved or removed without searching for it.
+*/
+
+// Ties are broken by type so events due on the same cycle always run in the same order
+int isEarlier(eventType a, eventType b)
+{
+	if (mEvents[a].when != mEvents[b].when)
+	{
+		return mEvents[a].when < mEvents[b].when;
+	}
+
+	return a < b;
+}
+
+void swapHeap(int a, int b)
+{
+	eventType temp = mHeap[a];
+	mHeap[a] = mHeap[b];
+	mHeap[b] = temp;
+
+	mHeapPosition[mHeap[a]] = a;
+	mHeapPosition[mHeap[b]] = b;
+}
+
+void siftUp(int position)
+{
+	while (position > 0)
+	{
+		int parent = (position - 1) / 2;
+		if (!isEarlier(mHeap[position], mHeap[parent]))
+		{
+			break;
+		}
+
+		swapHeap(position, parent);
+		position = parent;
+	}
+}
+
+void siftDown(int position)
+{
+	while (1)
+	{
+		int left = position * 2 + 1;
+		int right = left + 1;
+		int smallest = position;
+
+		if (left < mHeapSize && isEarlier(mHeap[left], mHeap[smallest]))
+		{
+			smallest = left;
+		}
+
+		if (right < mHeapSize && isEarlier(mHeap[right], mHeap[smallest]))
+		{
+			smallest = right;
+		}
+
+		if (smallest == position)
+		{
+			break;
+		}
+
+		swapHeap(position, smallest);
+		position = smallest;
+	}
+}
+
+void updateNextEvent()
+{
+	// With nothing scheduled the deadline is never reached
+	mNextEvent = mHeapSize ? mEvents[mHeap[0]].when : ~(CYCLES)0;
+}
+
+void initializeScheduler()
+{
+	int i;
+	for (i = 0; i < EVENT_COUNT; i++)
+	{
+		mHeapPosition[i] = -1;
+	}
+
+	mHeapSize = 0;
+	updateNextEvent();
+}
+
+// Schedules an event, replacing the deadline if one of the same type is already pending
+void scheduleEvent(eventType type, CYCLES when, eventCallback callback)
+{
+	mEvents[type].when = when;
+	mEvents[type].callback = callback;
+
+	int position = mHeapPosition[type];
+	if (position < 0)
+	{
+		position = mHeapSize++;
+		mHeap[position] = type;
+		mHeapPosition[type] = position;
+	}
+
+	// The deadline can move either way when rescheduling
+	siftUp(position);
+	siftDown(mHeapPosition[type]);
+
+	updateNextEvent();
+}
+
+void cancelEvent(eventType type)
+{
+	int position = mHeapPosition[type];
+	if (position < 0)
+	{
+		return;
+	}
+
+	mHeapSize--;
+	if (position != mHeapSize)
+	{
+		// Fill the hole with the last event and move it to wherever it belongs
+		eventType moved = mHeap[mHeapSize];
+		swapHeap(position, mHeapSize);
+		siftUp(position);
+		siftDown(mHeapPosition[moved]);
+	}
+
+	mHeapPosition[type] = -1;
+	updateNextEvent();
+}
+
+int isEventScheduled(eventType type)
+{
+	return mHeapPosition[type] >= 0;
+}
+
+CYCLES eventCycle(eventType type)
+{
+	return mEvents[type].when;
+}
+
+// Runs every event that is due, in order. Callbacks are free to schedule themselves again
+void runEvents()
+{
+	while (mHeapSize && mEvents[mHeap[0]].when <= clock)
+	{
+		eventType type = mHeap[0];
+		event due = mEvents[type];
+
+		cancelEvent(type);
+		due.callback(due.when);
+	}
+}
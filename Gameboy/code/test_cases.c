@@ -1,262 +1,2585 @@
-#include "opcodes.h"
-#include "cpu.h"
-#include "cartridge.h"
-#include <assert.h>
-
-#define NZ (assert(!isFlagSet(FLAG_Z)))
-#define NH (assert(!isFlagSet(FLAG_H)))
-#define NC (assert(!isFlagSet(FLAG_C)))
-#define CHECKSUM 0xC000
-
-void RESET_RUN()
-{
-	PC.pair = 0x00;
-}
-
-void TEST_RUN_CPU()
-{
-	PC.pair = 0x0000;
-
-	while (PC.pair != 0xFFFF)
-	{
-		cpuStep();
-	}
-
-	return;
-}
-
-BYTE GET_BYTE_VALUE(void *function)
-{
-	BYTE i;
-	for (i = 0; i <= 0xFF; i++)
-	{
-		if (mOpcodes[i].function == function)
-		{
-			return i;
-		}
-	}
-	return 0x00;
-}
-
-void ADD_END()
-{
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(JP);			// 0x00
-	mCartridge[PC.pair++] = 0xFF;						// 0x01
-	mCartridge[PC.pair++] = 0xFF;						// 0x02
-}
-
-void UPDATE_CRC()
-{
-	PC.pair = 0x1000;
-
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);		// 0x00
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_BC);		// 0x01
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_DE);		// 0x02
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_HL);		// 0x03
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);		// 0x04
-	mCartridge[PC.pair++] = ((CHECKSUM & 0xFF) >> 8) + 3;	// 0x05
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_B_HL);		// 0x06
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_L);			// 0x07
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_C_HL);		// 0x08
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_L);			// 0x09
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_D_HL);		// 0x0A
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_L);			// 0x0B
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_HL);			// 0x0C
-
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_BYTE);		// 0x0D
-	mCartridge[PC.pair++] = 0x08;							// 0x0E
-	mCartridge[PC.pair++] = GET_BYTE_VALUE(CB);				// 0x0F	--
-	mCartridge[PC.pair++] = 0x38;							// 0x10
-}
-
-void TEST_SPECIAL()
-{
-	// JR negative
-	{
-		RESET_RUN();
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x00
-		mCartridge[PC.pair++] = 0x00;						// 0x01
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JP);			// 0x02
-		mCartridge[PC.pair++] = 0x0D;						// 0x03
-		mCartridge[PC.pair++] = 0x00;						// 0x04
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x05
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x06
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x07
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x08
-		mCartridge[PC.pair++] = 2;							// 0x09
-		ADD_END();											// 0x0A, 0x0B,  0x0C
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);			// 0x0D
-		mCartridge[PC.pair++] = -9;							// 0x0E
-
-		TEST_RUN_CPU();
-
-		NZ;
-	}
-
-	// JR positive
-	{
-		RESET_RUN();
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x00
-		mCartridge[PC.pair++] = 0x00;						// 0x01
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);			// 0x02
-		mCartridge[PC.pair++] = 0x01;						// 0x03
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x04
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x05
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x06
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x07
-		mCartridge[PC.pair++] = 0x02;						// 0x08
-		ADD_END();
-
-		TEST_RUN_CPU();
-
-		NZ;
-	}
-
-	// JP HL
-	{
-		RESET_RUN();
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);	// 0x00
-		mCartridge[PC.pair++] = 0x07;						// 0x01
-		mCartridge[PC.pair++] = 0x00;						// 0x02
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x03		
-		mCartridge[PC.pair++] = 0x00;						// 0x04
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JP_HL);		// 0x05
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x06		
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x07		
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x08	
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x09
-		mCartridge[PC.pair++] = 0x02;						// 0x0A
-		ADD_END();
-
-		TEST_RUN_CPU();
-
-
-		NZ;
-	}
-
-	// POP AF
-	{
-		RESET_RUN();
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_WORD);	// 0x00
-		mCartridge[PC.pair++] = 0x12;						// 0x01
-		mCartridge[PC.pair++] = 0x00;						// 0x02
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_BC_A);	// 0x00
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_BC);	// 0x01	--
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_AF);		// 0x02
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);	// 0x03
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_DE);		// 0x04
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);		// 0x05
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);	// 0x06
-		mCartridge[PC.pair++] = 0x00;						// 0x07
-		mCartridge[PC.pair++] = 0xF0;						// 0x08		
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(AND_HL);		// 0x09
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x0A
-		mCartridge[PC.pair++] = 0x0E;						// 0x0B
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JP_NZ);		// 0x0C
-		mCartridge[PC.pair++] = 0xFF;						// 0x0D
-		mCartridge[PC.pair++] = 0xFF;						// 0x0E
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);		// 0x0F
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x10
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);		// 0x11
-		mCartridge[PC.pair++] = -17;						// 0x12
-		ADD_END();
-
-		TEST_RUN_CPU();
-
-		NZ;
-	}	
-
-	// DAA
-	{
-		RESET_RUN();
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE);		// 0x00
-		mCartridge[PC.pair++] = 0x00;						// 0x01
-		mCartridge[PC.pair++] = 0x00;						// 0x02
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_DE);	// 0x03	--
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_AF);		// 0x04
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(DAA);		// 0x05
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);	// 0x06
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);		// 0x07		
-		mCartridge[PC.pair++] = 0x00;						// 0x08
-		mCartridge[PC.pair++] = 0x00;						// 0x09
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_HL);		// 0x0A
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_L);		// 0x0B
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);		// 0x0C	
-		mCartridge[PC.pair++] = 0x00;						// 0x0D
-		mCartridge[PC.pair++] = 0x00;						// 0x0E
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_D);		// 0x0F
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);		// 0x10
-		mCartridge[PC.pair++] = -14;						// 0x11
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_E);		// 0x12
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(ADD_BYTE);	// 0x13
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_E_A);		// 0x14
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);		// 0x15
-		mCartridge[PC.pair++] = -19;						// 0x16
-
-		mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);		// 0x17	
-		mCartridge[PC.pair++] = 0x00;						// 0x18
-		mCartridge[PC.pair++] = 0x00;						// 0x19
-		ADD_END();
-	}
-}
-
-void TEST_HL_SP()
-{
-
-}
-
-void TEST_LD()
-{
-
-}
-
-void TEST_8BIT_LOGIC()
-{
-
-}
-
-void TEST_16BIT_LOGIC()
-{
-
-}
-
-void TEST_JR_JP_CALL_RET_RST()
-{
-
-}
-
-void TEST_A_HL()
-{
-
-}
-
-void TEST_MISC()
-{
-
-}
-
-void TEST_BIT_OPS()
-{
-
-}
-
-void TEST_OPCODES()
-{
-	// TEST_SPECIAL();
-	TEST_HL_SP();
-	TEST_LD();
-	TEST_8BIT_LOGIC();
-	TEST_16BIT_LOGIC();
-	TEST_JR_JP_CALL_RET_RST();
-	TEST_A_HL();
-	TEST_MISC();
-	TEST_BIT_OPS();
+#include "opcodes.h"
+#include "cpu.h"
+#include "cartridge.h"
+#include "interrupts.h"
+#include "gpu.h"
+#include "jit.h"
+#include "lazyflags.h"
+#include "alutables.h"
+#include "stopwatch.h"
+#include "fleet.h"
+#include "batch.h"
+#include "savestate.h"
+#include "rewind.h"
+#include "movie.h"
+#include "recompiler.h"
+#include "platform.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "context.h"
+
+#define NZ (assert(!isFlagSet(FLAG_Z)))
+#define NH (assert(!isFlagSet(FLAG_H)))
+#define NC (assert(!isFlagSet(FLAG_C)))
+#define CHECKSUM 0xC000
+
+void RESET_RUN()
+{
+	PC.pair = 0x00;
+}
+
+void TEST_RUN_CPU()
+{
+	PC.pair = 0x0000;
+
+	while (PC.pair != 0xFFFF)
+	{
+		cpuStep();
+	}
+
+	return;
+}
+
+BYTE GET_BYTE_VALUE(void *function)
+{
+	BYTE i;
+	for (i = 0; i <= 0xFF; i++)
+	{
+		if (mOpcodes[i].function == function)
+		{
+			return i;
+		}
+	}
+	return 0x00;
+}
+
+void ADD_END()
+{
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JP);			// 0x00
+	mCartridge[PC.pair++] = 0xFF;						// 0x01
+	mCartridge[PC.pair++] = 0xFF;						// 0x02
+}
+
+void UPDATE_CRC()
+{
+	PC.pair = 0x1000;
+
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);		// 0x00
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_BC);		// 0x01
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_DE);		// 0x02
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_HL);		// 0x03
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);		// 0x04
+	mCartridge[PC.pair++] = ((CHECKSUM & 0xFF) >> 8) + 3;	// 0x05
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_B_HL);		// 0x06
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_L);			// 0x07
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_C_HL);		// 0x08
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_L);			// 0x09
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_D_HL);		// 0x0A
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_L);			// 0x0B
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_HL);			// 0x0C
+
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_BYTE);		// 0x0D
+	mCartridge[PC.pair++] = 0x08;							// 0x0E
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CB);				// 0x0F	--
+	mCartridge[PC.pair++] = 0x38;							// 0x10
+}
+
+void TEST_SPECIAL()
+{
+	// JR negative
+	{
+		RESET_RUN();
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x00
+		mCartridge[PC.pair++] = 0x00;						// 0x01
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JP);			// 0x02
+		mCartridge[PC.pair++] = 0x0D;						// 0x03
+		mCartridge[PC.pair++] = 0x00;						// 0x04
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x05
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x06
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x07
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x08
+		mCartridge[PC.pair++] = 2;							// 0x09
+		ADD_END();											// 0x0A, 0x0B,  0x0C
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);			// 0x0D
+		mCartridge[PC.pair++] = -9;							// 0x0E
+
+		TEST_RUN_CPU();
+
+		NZ;
+	}
+
+	// JR positive
+	{
+		RESET_RUN();
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x00
+		mCartridge[PC.pair++] = 0x00;						// 0x01
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);			// 0x02
+		mCartridge[PC.pair++] = 0x01;						// 0x03
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x04
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x05
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x06
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x07
+		mCartridge[PC.pair++] = 0x02;						// 0x08
+		ADD_END();
+
+		TEST_RUN_CPU();
+
+		NZ;
+	}
+
+	// JP HL
+	{
+		RESET_RUN();
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);	// 0x00
+		mCartridge[PC.pair++] = 0x07;						// 0x01
+		mCartridge[PC.pair++] = 0x00;						// 0x02
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x03		
+		mCartridge[PC.pair++] = 0x00;						// 0x04
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JP_HL);		// 0x05
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x06		
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x07		
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);		// 0x08	
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x09
+		mCartridge[PC.pair++] = 0x02;						// 0x0A
+		ADD_END();
+
+		TEST_RUN_CPU();
+
+
+		NZ;
+	}
+
+	// POP AF
+	{
+		RESET_RUN();
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_WORD);	// 0x00
+		mCartridge[PC.pair++] = 0x12;						// 0x01
+		mCartridge[PC.pair++] = 0x00;						// 0x02
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_BC_A);	// 0x00
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_BC);	// 0x01	--
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_AF);		// 0x02
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);	// 0x03
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_DE);		// 0x04
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);		// 0x05
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);	// 0x06
+		mCartridge[PC.pair++] = 0x00;						// 0x07
+		mCartridge[PC.pair++] = 0xF0;						// 0x08		
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(AND_HL);		// 0x09
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);	// 0x0A
+		mCartridge[PC.pair++] = 0x0E;						// 0x0B
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JP_NZ);		// 0x0C
+		mCartridge[PC.pair++] = 0xFF;						// 0x0D
+		mCartridge[PC.pair++] = 0xFF;						// 0x0E
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);		// 0x0F
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x10
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);		// 0x11
+		mCartridge[PC.pair++] = -17;						// 0x12
+		ADD_END();
+
+		TEST_RUN_CPU();
+
+		NZ;
+	}	
+
+	// DAA
+	{
+		RESET_RUN();
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE);		// 0x00
+		mCartridge[PC.pair++] = 0x00;						// 0x01
+		mCartridge[PC.pair++] = 0x00;						// 0x02
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_DE);	// 0x03	--
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_AF);		// 0x04
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(DAA);		// 0x05
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);	// 0x06
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);		// 0x07		
+		mCartridge[PC.pair++] = 0x00;						// 0x08
+		mCartridge[PC.pair++] = 0x00;						// 0x09
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_HL);		// 0x0A
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_L);		// 0x0B
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);		// 0x0C	
+		mCartridge[PC.pair++] = 0x00;						// 0x0D
+		mCartridge[PC.pair++] = 0x00;						// 0x0E
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_D);		// 0x0F
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);		// 0x10
+		mCartridge[PC.pair++] = -14;						// 0x11
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_E);		// 0x12
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(ADD_BYTE);	// 0x13
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_E_A);		// 0x14
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);		// 0x15
+		mCartridge[PC.pair++] = -19;						// 0x16
+
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);		// 0x17	
+		mCartridge[PC.pair++] = 0x00;						// 0x18
+		mCartridge[PC.pair++] = 0x00;						// 0x19
+		ADD_END();
+	}
+}
+
+void TEST_HL_SP()
+{
+
+}
+
+void TEST_LD()
+{
+
+}
+
+void TEST_8BIT_LOGIC()
+{
+
+}
+
+void TEST_16BIT_LOGIC()
+{
+
+}
+
+void TEST_JR_JP_CALL_RET_RST()
+{
+
+}
+
+void TEST_A_HL()
+{
+
+}
+
+void TEST_MISC()
+{
+
+}
+
+// Sets up the registers for TEST_BIT_OPS, value goes into the register or (HL) the CB instruction works on
+void SET_CB_INPUTS(BYTE *target, int value, int flags)
+{
+	mLazyFlags.operation = LAZY_NONE;
+	registerAF.pair = (WORD)(0x9A00 | flags);
+	registerBC.pair = 0x1234;
+	registerDE.pair = 0x5678;
+	registerHL.pair = 0xC0DE;
+	clock = 0;
+
+	if (target == NULL)
+	{
+		writeMemory(registerHL.pair, (BYTE)value);
+	}
+	else
+	{
+		*target = (BYTE)value;
+	}
+}
+
+// Every CB instruction has to do to its register what the helper it decodes to does, and leave the other registers alone
+void TEST_BIT_OPS()
+{
+	BYTE *registers[8] = { &registerBC.hi, &registerBC.lo, &registerDE.hi, &registerDE.lo, &registerHL.hi, &registerHL.lo, NULL, &registerAF.hi };
+	BYTE (*shifts[8])(BYTE) = { RLC, RRC, RL, RR, SLA, SRA, SWAP, SRL };
+	int operand, value, flags;
+
+	for (operand = 0; operand < 0x100; operand++)
+	{
+		BYTE *target = registers[operand & 0x07];
+		BYTE bit = 1 << ((operand >> 3) & 0x07);
+
+		for (flags = 0; flags < 0x100; flags += 0x10)
+		{
+			for (value = 0; value < 0x100; value++)
+			{
+				BYTE expected = (BYTE)value;
+				WORD expectedAF, expectedBC, expectedDE, expectedHL;
+				CYCLES expectedClock;
+
+				SET_CB_INPUTS(target, value, flags);
+				switch (operand >> 6)
+				{
+				case 0: expected = shifts[(operand >> 3) & 0x07](expected); break;
+				case 1: BIT(bit, expected); break;
+				case 2: expected = RES(bit, expected); break;
+				case 3: expected = SET(bit, expected); break;
+				}
+				SET_CB_INPUTS(target, expected, registerAF.lo);
+				expectedAF = registerAF.pair;
+				expectedBC = registerBC.pair;
+				expectedDE = registerDE.pair;
+				expectedHL = registerHL.pair;
+				expectedClock = (target == NULL) ? 16 : 8;
+
+				SET_CB_INPUTS(target, value, flags);
+				CB((BYTE)operand);
+
+				assert(registerAF.pair == expectedAF);
+				assert(registerBC.pair == expectedBC);
+				assert(registerDE.pair == expectedDE);
+				assert(registerHL.pair == expectedHL);
+				assert(clock == expectedClock);
+				assert((target != NULL) || (readMemory(registerHL.pair) == expected));
+			}
+		}
+	}
+}
+
+// Runs one of the ALU helpers, eager from opcodes.c or lazy from lazyflags.c. Returns the result of INC and DEC
+BYTE RUN_ALU(int operation, int lazy, BYTE r)
+{
+	switch (operation)
+	{
+	case 0: return lazy ? lazyINC(r) : INC(r);
+	case 1: return lazy ? lazyDEC(r) : DEC(r);
+	case 2: lazy ? lazyADD(r) : ADD(r); break;
+	case 3: lazy ? lazyADC(r) : ADC(r); break;
+	case 4: lazy ? lazySUB(r) : SUB(r); break;
+	case 5: lazy ? lazySBC(r) : SBC(r); break;
+	case 6: lazy ? lazyAND(r) : AND(r); break;
+	case 7: lazy ? lazyXOR(r) : XOR(r); break;
+	case 8: lazy ? lazyOR(r) : OR(r); break;
+	case 9: lazy ? lazyCP(r) : CP(r); break;
+	case 10: lazy ? lazyADD_16((r << 8) | registerAF.hi) : ADD_16((r << 8) | registerAF.hi); break;
+	}
+
+	return 0;
+}
+
+#define ALU_OPERATIONS 11
+
+void SET_ALU_INPUTS(int a, int flags)
+{
+	mLazyFlags.operation = LAZY_NONE;
+	registerAF.hi = (BYTE)a;
+	registerAF.lo = (BYTE)flags;
+	registerHL.pair = (WORD)((a << 8) | (0xFF - a));
+}
+
+/*
+	The lazy helpers have to leave A, HL and F exactly like the eager ones. Every operation is run for every
+	A, operand and starting F, then pairs of operations are run back to back without looking at F in between
+	so INC, DEC, ADC, SBC and ADD_16 pick up flags that are still pending.
+*/
+void TEST_LAZY_FLAGS()
+{
+	int operation, second, a, r, flags;
+	BYTE eagerResult, lazyResult;
+	WORD eagerAF, eagerHL;
+
+	for (operation = 0; operation < ALU_OPERATIONS; operation++)
+	{
+		for (flags = 0; flags < 0x100; flags += 0x10)
+		{
+			for (a = 0; a < 0x100; a++)
+			{
+				for (r = 0; r < 0x100; r++)
+				{
+					SET_ALU_INPUTS(a, flags);
+					eagerResult = RUN_ALU(operation, 0, (BYTE)r);
+					eagerAF = registerAF.pair;
+					eagerHL = registerHL.pair;
+
+					SET_ALU_INPUTS(a, flags);
+					lazyResult = RUN_ALU(operation, 1, (BYTE)r);
+					evaluateFlags();
+
+					assert(eagerResult == lazyResult);
+					assert(eagerAF == registerAF.pair);
+					assert(eagerHL == registerHL.pair);
+				}
+			}
+		}
+	}
+
+	for (operation = 0; operation < ALU_OPERATIONS; operation++)
+	{
+		for (second = 0; second < ALU_OPERATIONS; second++)
+		{
+			for (a = 0; a < 0x100; a += 3)
+			{
+				for (r = 0; r < 0x100; r += 5)
+				{
+					SET_ALU_INPUTS(a, FLAG_C);
+					RUN_ALU(operation, 0, (BYTE)r);
+					eagerResult = RUN_ALU(second, 0, (BYTE)(r ^ a));
+					eagerAF = registerAF.pair;
+					eagerHL = registerHL.pair;
+
+					SET_ALU_INPUTS(a, FLAG_C);
+					RUN_ALU(operation, 1, (BYTE)r);
+					lazyResult = RUN_ALU(second, 1, (BYTE)(r ^ a));
+					evaluateFlags();
+
+					assert(eagerResult == lazyResult);
+					assert(eagerAF == registerAF.pair);
+					assert(eagerHL == registerHL.pair);
+				}
+			}
+		}
+	}
+}
+
+// Runs one of the branch based helpers or its table version. Returns the result of the ones that have one
+BYTE RUN_TABLE_ALU(int operation, int table, BYTE r)
+{
+	switch (operation)
+	{
+	case 0: return table ? tableINC(r) : INC(r);
+	case 1: return table ? tableDEC(r) : DEC(r);
+	case 2: table ? tableADD(r) : ADD(r); break;
+	case 3: table ? tableADC(r) : ADC(r); break;
+	case 4: table ? tableSUB(r) : SUB(r); break;
+	case 5: table ? tableSBC(r) : SBC(r); break;
+	case 6: table ? tableCP(r) : CP(r); break;
+	case 7: return table ? tableRLC(r) : RLC(r);
+	case 8: return table ? tableRRC(r) : RRC(r);
+	case 9: return table ? tableRL(r) : RL(r);
+	case 10: return table ? tableRR(r) : RR(r);
+	case 11: return table ? tableSLA(r) : SLA(r);
+	case 12: return table ? tableSRA(r) : SRA(r);
+	case 13: return table ? tableSWAP(r) : SWAP(r);
+	case 14: return table ? tableSRL(r) : SRL(r);
+	// The DAA handler takes its cycles itself
+	case 15: table ? (clock += 4, tableDAA()) : DAA(); break;
+	}
+
+	return 0;
+}
+
+#define TABLE_OPERATIONS 16
+
+// The tables have to give the same result, F and cycles as the helpers for every A, operand and starting F
+void TEST_TABLE_ALU()
+{
+	int operation, a, r, flags;
+	BYTE branchResult, tableResult;
+	WORD branchAF;
+	CYCLES branchClock;
+
+	initializeAluTables();
+
+	for (operation = 0; operation < TABLE_OPERATIONS; operation++)
+	{
+		for (flags = 0; flags < 0x100; flags += 0x10)
+		{
+			for (a = 0; a < 0x100; a++)
+			{
+				for (r = 0; r < 0x100; r++)
+				{
+					SET_ALU_INPUTS(a, flags);
+					clock = 0;
+					branchResult = RUN_TABLE_ALU(operation, 0, (BYTE)r);
+					branchAF = registerAF.pair;
+					branchClock = clock;
+
+					SET_ALU_INPUTS(a, flags);
+					clock = 0;
+					tableResult = RUN_TABLE_ALU(operation, 1, (BYTE)r);
+
+					assert(branchResult == tableResult);
+					assert(branchAF == registerAF.pair);
+					assert(branchClock == clock);
+				}
+			}
+		}
+	}
+}
+
+// Ends a program with a jump to itself and returns its address, RUN_PROGRAM checks a program got there
+WORD ADD_HANG()
+{
+	WORD hang = PC.pair;
+
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);
+	mCartridge[PC.pair++] = -2;
+
+	return hang;
+}
+
+/*
+	Runs the program built at 0x0000 from power on with the given engine for a number of cycles and returns
+	the PC it got to. The block cache starts out empty since the cartridge changed under it.
+*/
+WORD RUN_PROGRAM(cpuEngine engine, int cycles)
+{
+	cpuEngine previous = mEngine;
+
+	initializeHardware();
+	mEngine = engine;
+	PC.pair = 0x0000;
+
+	cpuRun(cycles);
+
+	mEngine = previous;
+	return PC.pair;
+}
+
+// Powers on with the timer counting every 16 cycles, TMA and TIMA set and clock at 0
+void SET_TIMER_INPUTS(BYTE modulo, BYTE counter)
+{
+	initializeHardware();
+	writeMemory(0xFFFF, 0x00);
+	writeMemory(0xFF06, modulo);
+	writeMemory(0xFF05, counter);
+	writeMemory(0xFF07, 0x05);
+}
+
+// DIV and TIMA are worked out from clock when they are read, moving clock on is all it takes to run the timers
+void TEST_TIMERS()
+{
+	WORD hang;
+	int engine;
+
+	// DIV is the top byte of a counter reset by any write to it
+	initializeHardware();
+	clock = 0x1234;
+	assert(readMemory(0xFF04) == 0x12);
+	writeMemory(0xFF04, 0x99);
+	assert(readMemory(0xFF04) == 0x00);
+	clock += 0x2FF;
+	assert(readMemory(0xFF04) == 0x02);
+
+	// TIMA keeps its count when TAC changes the period and stops going up when TAC stops it
+	SET_TIMER_INPUTS(0x00, 0x00);
+	clock = 160;
+	assert(readMemory(0xFF05) == 10);
+	writeMemory(0xFF07, 0x06);
+	clock = 256;
+	assert(readMemory(0xFF05) == 12);
+	writeMemory(0xFF07, 0x02);
+	clock += 10000;
+	assert(readMemory(0xFF05) == 12);
+
+	// Resetting DIV while the counter bit TIMA follows is set drops it to 0, which counts as a tick
+	SET_TIMER_INPUTS(0x00, 0x00);
+	clock = 24;
+	assert(readMemory(0xFF05) == 1);
+	writeMemory(0xFF04, 0x00);
+	assert(readMemory(0xFF05) == 2);
+	clock += 16;
+	assert(readMemory(0xFF05) == 3);
+	clock += 4;
+	writeMemory(0xFF04, 0x00);
+	assert(readMemory(0xFF05) == 3);
+
+	// TIMA starts again from TMA on every overflow and sets IF even with the interrupt masked in IE
+	SET_TIMER_INPUTS(0xF0, 0xFE);
+	clock = 32;
+	assert(readMemory(0xFF05) == 0xF0);
+	assert(readMemory(0xFF0F) & INTERRUPTS_TIMER);
+	clock += 16 * (0x10 + 0x10 + 5);
+	assert(readMemory(0xFF05) == 0xF5);
+
+	// A game can wait for the overflow by polling IF with only VBLANK enabled, without an event running the timers
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DI);				// 0x00
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x01
+	mCartridge[PC.pair++] = INTERRUPTS_VBLANK;				// 0x02
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x03
+	mCartridge[PC.pair++] = 0xFF;							// 0x04
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x05
+	mCartridge[PC.pair++] = 0x05;							// 0x06
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x07
+	mCartridge[PC.pair++] = 0x07;							// 0x08
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x09
+	mCartridge[PC.pair++] = 0x0F;							// 0x0A
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(AND_BYTE);		// 0x0B
+	mCartridge[PC.pair++] = INTERRUPTS_TIMER;				// 0x0C
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_Z);			// 0x0D
+	mCartridge[PC.pair++] = -6;								// 0x0E
+	hang = ADD_HANG();										// 0x0F, 0x10
+
+	// A recompiled cartridge only has code for itself, the engines that run any code are the ones before it
+	for (engine = 0; engine <= ENGINE_JIT; engine++)
+	{
+		assert(RUN_PROGRAM((cpuEngine)engine, CYCLES_PER_FRAME) == hang);
+	}
+}
+
+/*
+	Starts a program for TEST_INTERRUPTS at 0x0000 with interrupts off, B, C and E cleared and only the timer interrupt
+	enabled. The timer handler copies C to E, counts in B and returns with interrupts left off, so a program counts its
+	steps in C and E tells how far it got before the interrupt was taken.
+*/
+void START_INTERRUPT_PROGRAM()
+{
+	PC.pair = 0x50;
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_E_C);			// 0x50
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);			// 0x51
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(RET);			// 0x52
+
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DI);				// 0x00
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_BC);			// 0x01
+	mCartridge[PC.pair++] = 0x00;							// 0x02
+	mCartridge[PC.pair++] = 0x00;							// 0x03
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_E_C);			// 0x04
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x05
+	mCartridge[PC.pair++] = INTERRUPTS_TIMER;				// 0x06
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x07
+	mCartridge[PC.pair++] = 0xFF;							// 0x08
+}
+
+// Runs the program on every engine and checks how many interrupts it took (B), where it got (C) and where it was when one was taken (E)
+void CHECK_INTERRUPT_PROGRAM(WORD hang, BYTE taken, BYTE steps, BYTE stepsBefore)
+{
+	int engine;
+
+	for (engine = 0; engine <= ENGINE_JIT; engine++)
+	{
+		assert(RUN_PROGRAM((cpuEngine)engine, CYCLES_PER_FRAME) == hang);
+		assert(registerBC.hi == taken);
+		assert(registerBC.lo == steps);
+		assert(registerDE.lo == stepsBefore);
+	}
+}
+
+// pending has to follow every change to IE, IF and IME, and EI only lets interrupts in after the instruction after it
+void TEST_INTERRUPTS()
+{
+	WORD hang;
+
+	// EI straight followed by DI never lets the pending interrupt in
+	{
+		START_INTERRUPT_PROGRAM();
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x09
+		mCartridge[PC.pair++] = 0x0F;						// 0x0A
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(EI);			// 0x0B
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(DI);			// 0x0C
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x0D
+		hang = ADD_HANG();									// 0x0E, 0x0F
+
+		CHECK_INTERRUPT_PROGRAM(hang, 0, 1, 0);
+	}
+
+	// EI takes an interrupt that is already pending after the instruction that follows it, not before
+	{
+		START_INTERRUPT_PROGRAM();
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x09
+		mCartridge[PC.pair++] = 0x0F;						// 0x0A
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(EI);			// 0x0B
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x0C
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x0D
+		hang = ADD_HANG();									// 0x0E, 0x0F
+
+		CHECK_INTERRUPT_PROGRAM(hang, 1, 2, 1);
+	}
+
+	// A flag that is masked in IE waits, and is taken right after the write to IE that lets it through
+	{
+		START_INTERRUPT_PROGRAM();
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x09
+		mCartridge[PC.pair++] = 0x0F;						// 0x0A
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_A);		// 0x0B
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x0C
+		mCartridge[PC.pair++] = 0xFF;						// 0x0D
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(EI);			// 0x0E
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x0F
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x10
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x11
+		mCartridge[PC.pair++] = INTERRUPTS_TIMER;			// 0x12
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x13
+		mCartridge[PC.pair++] = 0xFF;						// 0x14
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x15
+		hang = ADD_HANG();									// 0x16, 0x17
+
+		CHECK_INTERRUPT_PROGRAM(hang, 1, 3, 2);
+	}
+
+	// Clearing IF takes back an interrupt that was waiting for IME
+	{
+		START_INTERRUPT_PROGRAM();
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x09
+		mCartridge[PC.pair++] = 0x0F;						// 0x0A
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_A);		// 0x0B
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x0C
+		mCartridge[PC.pair++] = 0x0F;						// 0x0D
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(EI);			// 0x0E
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x0F
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x10
+		hang = ADD_HANG();									// 0x11, 0x12
+
+		CHECK_INTERRUPT_PROGRAM(hang, 0, 2, 0);
+	}
+
+	// HALT sleeps until the timer overflows and the interrupt it raises wakes it up
+	{
+		START_INTERRUPT_PROGRAM();
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x09
+		mCartridge[PC.pair++] = 0x05;						// 0x0A
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x0B
+		mCartridge[PC.pair++] = 0x07;						// 0x0C
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(EI);			// 0x0D
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(HALT);		// 0x0E
+		mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);		// 0x0F
+		hang = ADD_HANG();									// 0x10, 0x11
+
+		CHECK_INTERRUPT_PROGRAM(hang, 1, 1, 0);
+	}
+}
+
+// Runs the program built at 0x0000 from power on one instruction at a time, a halt only moves clock 4 cycles a step
+void STEP_PROGRAM(CYCLES cycles)
+{
+	initializeHardware();
+	PC.pair = 0x0000;
+
+	while (clock < cycles)
+	{
+		stepInstruction();
+	}
+}
+
+/*
+	Builds a program that enables the given interrupts with IME set or not, starts the timer counting every 16
+	cycles and halts. The handlers count in B and the program counts in C once it wakes up. Every engine stops
+	at each cycle around the one stepping wakes up on and has to be in the same state as stepping there.
+*/
+void CHECK_HALT_PROGRAM(BYTE interrupts, int ime)
+{
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	CYCLES wake;
+	CYCLES cycles;
+	int engine;
+
+	assert(states);
+	PC.pair = 0x40;
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);			// 0x40
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(RETI);			// 0x41
+	PC.pair = 0x50;
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);			// 0x50
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(RETI);			// 0x51
+
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x00
+	mCartridge[PC.pair++] = interrupts;						// 0x01
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x02
+	mCartridge[PC.pair++] = 0xFF;							// 0x03
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x04
+	mCartridge[PC.pair++] = 0x05;							// 0x05
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x06
+	mCartridge[PC.pair++] = 0x07;							// 0x07
+	mCartridge[PC.pair++] = ime ? GET_BYTE_VALUE(EI) : GET_BYTE_VALUE(DI);	// 0x08
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(HALT);			// 0x09
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);			// 0x0A
+	ADD_HANG();												// 0x0B, 0x0C
+
+	// Steps to the HALT and on to the first cycle that isn't halted anymore
+	initializeHardware();
+	PC.pair = 0x0000;
+
+	while (!halt && (clock < 2 * CYCLES_PER_FRAME))
+	{
+		stepInstruction();
+	}
+
+	while (halt && (clock < 2 * CYCLES_PER_FRAME))
+	{
+		stepInstruction();
+	}
+
+	wake = clock;
+	assert((wake > 16) && (wake < 2 * CYCLES_PER_FRAME));
+
+	for (cycles = wake - 16; cycles <= wake + 64; cycles += 4)
+	{
+		STEP_PROGRAM(cycles);
+		gpuCatchUp();
+		saveSnapshot(&states[0]);
+
+		for (engine = 0; engine <= ENGINE_JIT; engine++)
+		{
+			RUN_PROGRAM((cpuEngine)engine, (int)cycles);
+			gpuCatchUp();
+			saveSnapshot(&states[1]);
+			assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+		}
+	}
+
+	// Woke up and went on from the HALT, C powers on as 0x13, and only took the interrupt with IME set
+	assert(registerBC.hi == (ime ? 1 : 0));
+	assert(registerBC.lo == 0x14);
+
+	free(states);
+}
+
+// Skipping a halt ends it on the same cycle as stepping through it, whether the interrupt is taken or not
+void TEST_HALT()
+{
+	CHECK_HALT_PROGRAM(INTERRUPTS_TIMER, 1);
+	CHECK_HALT_PROGRAM(INTERRUPTS_VBLANK, 1);
+	CHECK_HALT_PROGRAM(INTERRUPTS_TIMER, 0);
+}
+
+/*
+	Runs the program built at 0x0000 for a frame with the interpreter and then with every other engine, and checks
+	they all end on the same cycle with the same registers and HRAM. Returns the PC the interpreter got to.
+*/
+WORD CHECK_ENGINES_AGREE()
+{
+	Register af, bc, de, hl;
+	CYCLES cycles;
+	BYTE hram[0x7F];
+	WORD pc = RUN_PROGRAM(ENGINE_INTERPRETER, CYCLES_PER_FRAME);
+	int engine;
+
+	RESOLVE_FLAGS();
+	af = registerAF;
+	bc = registerBC;
+	de = registerDE;
+	hl = registerHL;
+	cycles = clock;
+	memcpy(hram, &cpu[0xFF80], sizeof(hram));
+
+	for (engine = ENGINE_BLOCK_CACHE; engine <= ENGINE_JIT; engine++)
+	{
+		assert(RUN_PROGRAM((cpuEngine)engine, CYCLES_PER_FRAME) == pc);
+		RESOLVE_FLAGS();
+		assert(registerAF.pair == af.pair);
+		assert(registerBC.pair == bc.pair);
+		assert(registerDE.pair == de.pair);
+		assert(registerHL.pair == hl.pair);
+		assert(clock == cycles);
+		assert(memcmp(hram, &cpu[0xFF80], sizeof(hram)) == 0);
+	}
+
+	return pc;
+}
+
+/*
+	A block decoded from RAM has to be thrown away when the code under it is written, and one decoded from the
+	switchable ROM bank when another bank is switched in. A routine in WRAM returns the operand of its LD A,n in B and
+	the program patches it each time round, then it calls 0x4000 with banks 1 and 2 in turn, which count in D and E.
+*/
+void TEST_BLOCK_CACHE()
+{
+	WORD at = ROM_BANK_SIZE;
+
+	mCartridge[at++] = GET_BYTE_VALUE(INC_D);				// 1:0x4000
+	mCartridge[at++] = GET_BYTE_VALUE(RET);					// 1:0x4001
+	at = 2 * ROM_BANK_SIZE;
+	mCartridge[at++] = GET_BYTE_VALUE(INC_E);				// 2:0x4000
+	mCartridge[at++] = GET_BYTE_VALUE(RET);					// 2:0x4001
+
+	// LD A,0; RET at C000, C counts the banks and DE the calls to them
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_A);			// 0x00
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x01
+	mCartridge[PC.pair++] = 0x01;							// 0x02
+	mCartridge[PC.pair++] = 0xC0;							// 0x03
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x04
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x05
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x06
+	mCartridge[PC.pair++] = 0x00;							// 0x07
+	mCartridge[PC.pair++] = 0xC0;							// 0x08
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x09
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(RET);			// 0x0A
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x0B
+	mCartridge[PC.pair++] = 0x02;							// 0x0C
+	mCartridge[PC.pair++] = 0xC0;							// 0x0D
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_C);			// 0x0E
+	mCartridge[PC.pair++] = 0x01;							// 0x0F
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE);			// 0x10
+	mCartridge[PC.pair++] = 0x00;							// 0x11
+	mCartridge[PC.pair++] = 0x00;							// 0x12
+
+	// Calls the routine and writes the next operand over it
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);			// 0x13
+	mCartridge[PC.pair++] = 0x00;							// 0x14
+	mCartridge[PC.pair++] = 0xC0;							// 0x15
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_B_A);			// 0x16
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);			// 0x17
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x18
+	mCartridge[PC.pair++] = 0x01;							// 0x19
+	mCartridge[PC.pair++] = 0xC0;							// 0x1A
+
+	// Switches between banks 1 and 2 and calls the code at 0x4000
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);			// 0x1B
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_BYTE);		// 0x1C
+	mCartridge[PC.pair++] = 0x03;							// 0x1D
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_C_A);			// 0x1E
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x1F
+	mCartridge[PC.pair++] = 0x00;							// 0x20
+	mCartridge[PC.pair++] = 0x20;							// 0x21
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);			// 0x22
+	mCartridge[PC.pair++] = 0x00;							// 0x23
+	mCartridge[PC.pair++] = 0x40;							// 0x24
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);				// 0x25
+	mCartridge[PC.pair++] = -20;							// 0x26
+
+	CHECK_ENGINES_AGREE();
+
+	// Both banks ran as often and the routine saw every patch
+	assert(((registerDE.lo - registerDE.hi) & 0xFF) <= 1);
+	assert((registerBC.hi == (BYTE)(registerDE.hi + registerDE.lo)) ||
+		(registerBC.hi == (BYTE)(registerDE.hi + registerDE.lo - 1)));
+}
+
+#define TEST_IDLE_LOOPS_FRAMES 8
+
+/*
+	Skipping an idle loop leaves the same state behind as going round it. The program waits for LY to reach 144, which
+	comes with the VBLANK event, then 145 and the LCD mode of the next line 0, which don't, so skipping has to stop at
+	events and where the gpu changes mode both. It counts frames in B and C. Every engine runs it with idle loops skipped and gone round,
+	and the gpu is caught up before each snapshot so it is compared as of the same cycle.
+*/
+void TEST_IDLE_LOOPS()
+{
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	int skipping = mIdleLoopSkipping;
+	int engine;
+	int skip;
+
+	assert(states);
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x00
+	mCartridge[PC.pair++] = 0x44;							// 0x01
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);		// 0x02
+	mCartridge[PC.pair++] = 0x90;							// 0x03
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);			// 0x04
+	mCartridge[PC.pair++] = -6;								// 0x05
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x06
+	mCartridge[PC.pair++] = 0x44;							// 0x07
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);		// 0x08
+	mCartridge[PC.pair++] = 0x91;							// 0x09
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);			// 0x0A
+	mCartridge[PC.pair++] = -6;								// 0x0B
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);			// 0x0C
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x0D
+	mCartridge[PC.pair++] = 0x41;							// 0x0E
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(AND_BYTE);		// 0x0F
+	mCartridge[PC.pair++] = 0x03;							// 0x10
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CP_BYTE);		// 0x11
+	mCartridge[PC.pair++] = 0x03;							// 0x12
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);			// 0x13
+	mCartridge[PC.pair++] = -8;								// 0x14
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);			// 0x15
+
+	// Waits 20 cycles for every frame so far before polling again, so the loops start at a different point each time
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);			// 0x16
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_A);			// 0x17
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(NOP);			// 0x18
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);			// 0x19
+	mCartridge[PC.pair++] = -4;								// 0x1A
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);				// 0x1B
+	mCartridge[PC.pair++] = -29;							// 0x1C
+
+	RUN_PROGRAM(ENGINE_INTERPRETER, TEST_IDLE_LOOPS_FRAMES * CYCLES_PER_FRAME);
+	gpuCatchUp();
+	saveSnapshot(&states[0]);
+	assert(registerBC.hi == TEST_IDLE_LOOPS_FRAMES);
+
+	for (engine = ENGINE_BLOCK_CACHE; engine <= ENGINE_JIT; engine++)
+	{
+		for (skip = 0; skip < 2; skip++)
+		{
+			mIdleLoopSkipping = skip;
+			mIdleLoopCycles = 0;
+			RUN_PROGRAM((cpuEngine)engine, TEST_IDLE_LOOPS_FRAMES * CYCLES_PER_FRAME);
+			gpuCatchUp();
+			saveSnapshot(&states[1]);
+			assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+			assert(skip ? (mIdleLoopCycles > 0) : (mIdleLoopCycles == 0));
+		}
+	}
+
+	mIdleLoopSkipping = skipping;
+	free(states);
+}
+
+/*
+	A compiled block that writes over code leaves as soon as the write lands, like the block cache. The
+	differential mode rewinds the block to run it a second time, code tracking included, so both runs stop at
+	the same place and it finds nothing wrong with a jit that is right.
+*/
+void TEST_JIT_VERIFY()
+{
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x00
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(RET);			// 0x01
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x02
+	mCartridge[PC.pair++] = 0x81;							// 0x03
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_C);			// 0x04
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B);			// 0x05
+
+	// Writes INC B or DEC B over the routine at FF80 and calls it, the write is in the middle of the block
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);			// 0x06
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x07
+	mCartridge[PC.pair++] = 0x80;							// 0x08
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_D);			// 0x09
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_E);			// 0x0A
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(CALL);			// 0x0B
+	mCartridge[PC.pair++] = 0x80;							// 0x0C
+	mCartridge[PC.pair++] = 0xFF;							// 0x0D
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);			// 0x0E
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(XOR_BYTE);		// 0x0F
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_B) ^ GET_BYTE_VALUE(DEC_B);	// 0x10
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_C_A);			// 0x11
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);				// 0x12
+	mCartridge[PC.pair++] = -14;							// 0x13
+
+	CHECK_ENGINES_AGREE();
+
+	mJitVerify = 1;
+	mJitMismatches = 0;
+	RUN_PROGRAM(ENGINE_JIT, CYCLES_PER_FRAME);
+	mJitVerify = 0;
+	assert(mJitMismatches == 0);
+}
+
+/*
+	Echo RAM reads and writes the WRAM 0x2000 below it, switching a bank points its pages at the new bank, and ROM
+	has no write pointer so writes to it reach the MBC instead of the cartridge
+*/
+void TEST_MEMORY_MAP()
+{
+	int page;
+
+	initializeHardware();
+
+	for (page = 0xE0; page < 0xFE; page++)
+	{
+		assert(mReadPages[page] == mReadPages[page - 0x20]);
+	}
+
+	writeMemory(0xC123, 0x5A);
+	assert(readMemory(0xE123) == 0x5A);
+	writeMemory(0xFDFF, 0xA5);
+	assert(readMemory(0xDDFF) == 0xA5);
+	assert(readMemory(0xFDFF) == 0xA5);
+
+	// ROM banks 1 and 2 at 0x4000
+	mCartridge[0x2000] = 0x00;
+	mCartridge[ROM_BANK_SIZE + 0x10] = 0x11;
+	mCartridge[(2 * ROM_BANK_SIZE) + 0x10] = 0x22;
+
+	for (page = 0x00; page < 0x80; page++)
+	{
+		assert(!mWritePages[page]);
+	}
+
+	writeMemory(0x2000, 0x01);
+	assert((mCartridge[0x2000] == 0x00) && (mMBC.romBank == 0x01));
+	assert(mReadPages[0x40] == &mCartridge[ROM_BANK_SIZE]);
+	assert(readMemory(0x4010) == 0x11);
+	writeMemory(0x2000, 0x02);
+	assert(mReadPages[0x7F] == &mCartridge[(2 * ROM_BANK_SIZE) + 0x3F00]);
+	assert(readMemory(0x4010) == 0x22);
+
+	// Register 3 set makes register 2 pick the ext RAM bank
+	writeMemory(0x6000, 0x01);
+	writeMemory(0xA010, 0x33);
+	writeMemory(0x4000, 0x01);
+	writeMemory(0xA010, 0x44);
+	assert(mReadPages[0xA0] == &mExtRAM[RAM_BANK_SIZE]);
+	assert(mExtRAM[RAM_BANK_SIZE + 0x10] == 0x44);
+	writeMemory(0x4000, 0x00);
+	assert(readMemory(0xA010) == 0x33);
+	assert(mExtRAM[0x10] == 0x33);
+}
+
+// The registers with a handler in the I/O tables do what they do on hardware when they are read and written
+void TEST_IO()
+{
+	int i;
+
+	// Writing anything to DIV resets it
+	RESET_RUN();
+	ADD_HANG();
+	RUN_PROGRAM(ENGINE_INTERPRETER, 0x3FF);
+	assert(readMemory(0xFF04) == (BYTE)(clock >> 8));
+	assert(readMemory(0xFF04) > 0);
+	writeMemory(0xFF04, 0x77);
+	assert(readMemory(0xFF04) == 0);
+	cpuRun(0x100);
+	assert(readMemory(0xFF04) == 1);
+
+	// DMA copies 160 bytes from the page written to FF46 into OAM
+	for (i = 0; i < 0xA0; i++)
+	{
+		writeMemory((WORD)(0xC100 + i), (BYTE)(i ^ 0x5A));
+	}
+
+	writeMemory(0xFF46, 0xC1);
+
+	for (i = 0; i < 0xA0; i++)
+	{
+		assert(readMemory((WORD)(0xFE00 + i)) == (BYTE)(i ^ 0x5A));
+	}
+
+	// FF00 reads the buttons with bit 5 cleared and the directions with bit 4 cleared, pressed is 0
+	setJoypad(JOYPAD_A | JOYPAD_START | JOYPAD_DOWN);
+	writeMemory(0xFF00, 0x10);
+	assert((readMemory(0xFF00) & 0x0F) == 0x06);
+	writeMemory(0xFF00, 0x20);
+	assert((readMemory(0xFF00) & 0x0F) == 0x07);
+	setJoypad(0);
+	assert((readMemory(0xFF00) & 0x0F) == 0x0F);
+
+	// IF and IE are the interrupt state, and what is pending follows each write to them
+	writeMemory(0xFF0F, INTERRUPTS_TIMER | INTERRUPTS_SERIAL);
+	assert(interrupt.flags == (INTERRUPTS_TIMER | INTERRUPTS_SERIAL));
+	assert(readMemory(0xFF0F) == (INTERRUPTS_TIMER | INTERRUPTS_SERIAL));
+	assert(interrupt.pending == 0);
+	writeMemory(0xFFFF, INTERRUPTS_TIMER | INTERRUPTS_VBLANK);
+	assert(interrupt.enable == (INTERRUPTS_TIMER | INTERRUPTS_VBLANK));
+	assert(readMemory(0xFFFF) == (INTERRUPTS_TIMER | INTERRUPTS_VBLANK));
+	assert(interrupt.pending == INTERRUPTS_TIMER);
+	writeMemory(0xFF0F, 0x00);
+	assert(interrupt.pending == 0);
+}
+
+#define TEST_GPU_CATCH_UP_CYCLES (3 * CYCLES_PER_FRAME / 2)
+
+// Folds every line the gpu draws into the hash at user
+void HASH_LINE(const float *colours, int line, void *user)
+{
+	unsigned int *hash = (unsigned int*)user;
+	int i;
+
+	for (i = 0; i < SCREEN_WIDTH * 3; i++)
+	{
+		*hash = (*hash * 31) + (unsigned int)(colours[i] * 3.0f) + line;
+	}
+}
+
+// Each run draws from and keeps its reads in memory that starts out the same
+void CLEAR_GPU_CATCH_UP_MEMORY()
+{
+	memset(&cpu[0x8000], 0, 0x2000);
+	memset(&cpu[0xC000], 0, 0x2000);
+	memset(&cpu[0xFE00], 0, 0xA0);
+	memset(mCurrentLinePixels, 0, sizeof(mCurrentLinePixels));
+}
+
+/*
+	The gpu only catches up when something could tell, which has to look exactly like it keeping up all the time.
+	A program reads LY and STAT at a different point of the line each time round for a frame and a half and writes
+	VRAM and OAM in between, and the STAT interrupt it takes keeps LY and STAT as well. Every engine has to end up
+	with the same memory, state and drawn lines as stepping with the gpu caught up after every instruction.
+*/
+void TEST_GPU_CATCH_UP()
+{
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	unsigned int hashes[2] = { 0, 0 };
+	platform hashing;
+	BYTE modes = 0;
+	WORD at;
+	int engine;
+
+	assert(states);
+	memset(&hashing, 0, sizeof(hashing));
+	hashing.line = HASH_LINE;
+
+	// The STAT handler keeps A, which tells how far into the wait it came, LY and STAT at DE
+	PC.pair = 0x48;
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(PUSH_AF);		// 0x48
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE_A);		// 0x49
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_DE);			// 0x4A
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x4B
+	mCartridge[PC.pair++] = 0x44;							// 0x4C
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE_A);		// 0x4D
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_DE);			// 0x4E
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x4F
+	mCartridge[PC.pair++] = 0x41;							// 0x50
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE_A);		// 0x51
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_DE);			// 0x52
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(POP_AF);			// 0x53
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(RETI);			// 0x54
+
+	RESET_RUN();
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_HL_WORD);		// 0x00
+	mCartridge[PC.pair++] = 0x00;							// 0x01
+	mCartridge[PC.pair++] = 0xC0;							// 0x02
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_DE);			// 0x03
+	mCartridge[PC.pair++] = 0x00;							// 0x04
+	mCartridge[PC.pair++] = 0xD0;							// 0x05
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x06
+	mCartridge[PC.pair++] = INTERRUPTS_LCDSTAT;				// 0x07
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x08
+	mCartridge[PC.pair++] = 0xFF;							// 0x09
+
+	// Sprites on
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_BYTE);		// 0x0A
+	mCartridge[PC.pair++] = 0x93;							// 0x0B
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_FF02X_A);		// 0x0C
+	mCartridge[PC.pair++] = 0x40;							// 0x0D
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(EI);				// 0x0E
+
+	// Keeps LY and STAT at HL, writes STAT to the first byte of tile 0 and moves sprite 0, which draws tile 0, onto the next line and along it
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x0F
+	mCartridge[PC.pair++] = 0x44;							// 0x10
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LDI_HL_A);		// 0x11
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_B_A);			// 0x12
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_FF02X);		// 0x13
+	mCartridge[PC.pair++] = 0x41;							// 0x14
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LDI_HL_A);		// 0x15
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x16
+	mCartridge[PC.pair++] = 0x00;							// 0x17
+	mCartridge[PC.pair++] = 0x80;							// 0x18
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_B);			// 0x19
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(ADD_BYTE);		// 0x1A
+	mCartridge[PC.pair++] = 0x11;							// 0x1B
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x1C
+	mCartridge[PC.pair++] = 0x00;							// 0x1D
+	mCartridge[PC.pair++] = 0xFE;							// 0x1E
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_C);			// 0x1F
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_A_C);			// 0x20
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(LD_04X_A);		// 0x21
+	mCartridge[PC.pair++] = 0x01;							// 0x22
+	mCartridge[PC.pair++] = 0xFE;							// 0x23
+
+	// Waits 16 cycles 1 to 8 times, so the next reads land somewhere else in the line
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(AND_BYTE);		// 0x24
+	mCartridge[PC.pair++] = 0x07;							// 0x25
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(INC_A);			// 0x26
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(DEC_A);			// 0x27
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR_NZ);			// 0x28
+	mCartridge[PC.pair++] = -3;								// 0x29
+	mCartridge[PC.pair++] = GET_BYTE_VALUE(JR);				// 0x2A
+	mCartridge[PC.pair++] = -29;							// 0x2B
+
+	CLEAR_GPU_CATCH_UP_MEMORY();
+	hashing.user = &hashes[0];
+	setPlatform(&hashing);
+	initializeHardware();
+	PC.pair = 0x0000;
+
+	while (clock < TEST_GPU_CATCH_UP_CYCLES)
+	{
+		stepInstruction();
+		gpuCatchUp();
+	}
+
+	saveSnapshot(&states[0]);
+
+	// The program saw the gpu in every mode, and the interrupt always came at the start of HBLANK
+	assert(registerHL.pair < 0xD000);
+	for (at = 0xC000; at < registerHL.pair; at += 2)
+	{
+		modes |= 1 << (cpu[at + 1] & 0x03);
+	}
+
+	assert(modes == 0x0F);
+	assert(registerDE.pair > 0xD000 + (3 * 144));
+	for (at = 0xD000; at < registerDE.pair; at += 3)
+	{
+		assert((cpu[at + 2] & 0x03) == 0);
+	}
+
+	for (engine = 0; engine <= ENGINE_JIT; engine++)
+	{
+		CLEAR_GPU_CATCH_UP_MEMORY();
+		hashes[1] = 0;
+		hashing.user = &hashes[1];
+		setPlatform(&hashing);
+		RUN_PROGRAM((cpuEngine)engine, TEST_GPU_CATCH_UP_CYCLES);
+		gpuCatchUp();
+		saveSnapshot(&states[1]);
+		assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+		assert(hashes[0] == hashes[1]);
+	}
+
+	memset(&hashing, 0, sizeof(hashing));
+	setPlatform(&hashing);
+	free(states);
+}
+
+/*
+	Builds a program at 0x100 that keeps an instance busy the way a game does, so the tests below have something to
+	run without a ROM. It counts frames in HRAM and resets DIV from the VBLANK interrupt, and goes round WRAM mixing
+	the buttons, DIV, TIMA and what was there before into every byte, counting the odd ones in C. Different buttons
+	end up somewhere else.
+*/
+void BUILD_BUSY_CARTRIDGE(BYTE *cartridge)
+{
+	WORD at = 0x40;
+
+	// VBLANK
+	cartridge[at++] = GET_BYTE_VALUE(PUSH_AF);		// 0x40
+	cartridge[at++] = GET_BYTE_VALUE(PUSH_HL);		// 0x41
+	cartridge[at++] = GET_BYTE_VALUE(LD_HL_WORD);	// 0x42
+	cartridge[at++] = 0x80;							// 0x43
+	cartridge[at++] = 0xFF;							// 0x44
+	cartridge[at++] = GET_BYTE_VALUE(INC_HL_P);		// 0x45
+	cartridge[at++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x46
+	cartridge[at++] = 0x04;							// 0x47
+	cartridge[at++] = GET_BYTE_VALUE(POP_HL);		// 0x48
+	cartridge[at++] = GET_BYTE_VALUE(POP_AF);		// 0x49
+	cartridge[at++] = GET_BYTE_VALUE(RETI);			// 0x4A
+
+	// Only VBLANK is enabled, TIMA counts every 16 cycles
+	at = 0x100;
+	cartridge[at++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x100
+	cartridge[at++] = INTERRUPTS_VBLANK;			// 0x101
+	cartridge[at++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x102
+	cartridge[at++] = 0xFF;							// 0x103
+	cartridge[at++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x104
+	cartridge[at++] = 0x05;							// 0x105
+	cartridge[at++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x106
+	cartridge[at++] = 0x07;							// 0x107
+	cartridge[at++] = GET_BYTE_VALUE(EI);			// 0x108
+	cartridge[at++] = GET_BYTE_VALUE(LD_HL_WORD);	// 0x109
+	cartridge[at++] = 0x00;							// 0x10A
+	cartridge[at++] = 0xC0;							// 0x10B
+
+	// Select the buttons and read them
+	cartridge[at++] = GET_BYTE_VALUE(LD_A_BYTE);	// 0x10C
+	cartridge[at++] = 0x10;							// 0x10D
+	cartridge[at++] = GET_BYTE_VALUE(LD_FF02X_A);	// 0x10E
+	cartridge[at++] = 0x00;							// 0x10F
+	cartridge[at++] = GET_BYTE_VALUE(LD_A_FF02X);	// 0x110
+	cartridge[at++] = 0x00;							// 0x111
+	cartridge[at++] = GET_BYTE_VALUE(LD_B_A);		// 0x112
+	cartridge[at++] = GET_BYTE_VALUE(LD_A_FF02X);	// 0x113
+	cartridge[at++] = 0x04;							// 0x114
+	cartridge[at++] = GET_BYTE_VALUE(XOR_B);		// 0x115
+	cartridge[at++] = GET_BYTE_VALUE(LD_B_A);		// 0x116
+	cartridge[at++] = GET_BYTE_VALUE(LD_A_FF02X);	// 0x117
+	cartridge[at++] = 0x05;							// 0x118
+	cartridge[at++] = GET_BYTE_VALUE(XOR_B);		// 0x119
+	cartridge[at++] = GET_BYTE_VALUE(XOR_HL);		// 0x11A
+	cartridge[at++] = GET_BYTE_VALUE(LDI_HL_A);		// 0x11B
+
+	// RES 5,H wraps E000 round to C000
+	cartridge[at++] = GET_BYTE_VALUE(CB);			// 0x11C
+	cartridge[at++] = 0xAC;							// 0x11D
+	cartridge[at++] = GET_BYTE_VALUE(AND_BYTE);		// 0x11E
+	cartridge[at++] = 0x01;							// 0x11F
+	cartridge[at++] = GET_BYTE_VALUE(JR_Z);			// 0x120
+	cartridge[at++] = 0x01;							// 0x121
+	cartridge[at++] = GET_BYTE_VALUE(INC_C);		// 0x122
+	cartridge[at++] = GET_BYTE_VALUE(JR);			// 0x123
+	cartridge[at++] = -25;							// 0x124
+}
+
+void RUN_FRAMES(int frames)
+{
+	int frame;
+
+	for (frame = 0; frame < frames; frame++)
+	{
+		cpuRun(CYCLES_PER_FRAME);
+	}
+}
+
+// Makes an instance with the busy cartridge and the given buttons held and runs it for a number of frames
+GameBoy *RUN_BUSY_GAMEBOY(BYTE buttons, int frames)
+{
+	GameBoy *instance = createGameBoy();
+
+	assert(instance);
+	BUILD_BUSY_CARTRIDGE(mCartridge);
+	setJoypad(buttons);
+	RUN_FRAMES(frames);
+
+	return instance;
+}
+
+// The global checksum of a 32 kb cartridge is the sum of every other byte in it
+void SET_CARTRIDGE_CHECKSUM(BYTE *cartridge)
+{
+	WORD checksum = 0;
+	int i;
+
+	for (i = 0; i < 2 * ROM_BANK_SIZE; i++)
+	{
+		if ((i != GLOBAL_CHECKSUM_BYTE) && (i != GLOBAL_CHECKSUM_BYTE + 1))
+		{
+			checksum += cartridge[i];
+		}
+	}
+
+	cartridge[GLOBAL_CHECKSUM_BYTE] = (BYTE)(checksum >> 8);
+	cartridge[GLOBAL_CHECKSUM_BYTE + 1] = (BYTE)checksum;
+}
+
+/*
+	The busy cartridge with a header that says 32 kb and a global checksum, so it can be written out as a ROM and
+	told apart from the programs the other tests build, which have none
+*/
+void BUILD_TEST_CARTRIDGE(BYTE *cartridge)
+{
+	const char *title = "TESTS";
+
+	BUILD_BUSY_CARTRIDGE(cartridge);
+	memcpy(&cartridge[TITLE_BYTE], title, strlen(title));
+	cartridge[ROM_SIZE_BYTE] = 0x00;
+	SET_CARTRIDGE_CHECKSUM(cartridge);
+}
+
+// Writes the test cartridge as a ROM for headless -recompile, returns 0 when the file can't be written
+int WRITE_TEST_CARTRIDGE(char *output)
+{
+	BYTE *cartridge = (BYTE*)calloc(2 * ROM_BANK_SIZE, SIZE_OF_BYTE);
+	FILE *fp;
+	size_t written;
+
+	if (!cartridge)
+	{
+		return 0;
+	}
+
+	fopen_s(&fp, output, "wb");
+	if (!fp)
+	{
+		free(cartridge);
+		return 0;
+	}
+
+	BUILD_TEST_CARTRIDGE(cartridge);
+	written = fwrite(cartridge, SIZE_OF_BYTE, 2 * ROM_BANK_SIZE, fp);
+	fclose(fp);
+	free(cartridge);
+
+	return written == 2 * ROM_BANK_SIZE;
+}
+
+#ifdef RECOMPILED_CARTRIDGE
+#define TEST_RECOMPILED_FRAMES 10
+
+/*
+	Only a build with the test cartridge translated to C linked in has this test, see add_recompiled_headless in
+	CMakeLists.txt. Running the cartridge from the recompiled blocks ends up exactly where the interpreter does,
+	and so does a cartridge that isn't the one linked in, which goes through the block cache instead.
+*/
+void TEST_RECOMPILED()
+{
+	GameBoy *current = gb;
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	int run;
+
+	assert(states);
+	for (run = 0; run < 4; run++)
+	{
+		GameBoy *instance = createGameBoy();
+
+		assert(instance);
+		BUILD_TEST_CARTRIDGE(mCartridge);
+		assert(findRecompiledBlock(0, 0x0100) && findRecompiledBlock(0, 0x0040));
+
+		// The first two runs are the cartridge that was linked in, the last two one that counts other bytes in C
+		if (run >= 2)
+		{
+			mCartridge[0x11F] = 0x02;
+			SET_CARTRIDGE_CHECKSUM(mCartridge);
+		}
+
+		mEngine = (run & 1) ? ENGINE_INTERPRETER : ENGINE_RECOMPILED;
+		setJoypad(JOYPAD_A);
+		RUN_FRAMES(TEST_RECOMPILED_FRAMES);
+		saveSnapshot(&states[run & 1]);
+		destroyGameBoy(instance);
+
+		if (run & 1)
+		{
+			assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+		}
+	}
+
+	free(states);
+	selectGameBoy(current);
+}
+#endif
+
+#define TEST_FLEET_INSTANCES 5
+#define TEST_FLEET_WORKERS 3
+#define TEST_FLEET_QUANTA 20
+
+// Only the worker running an instance calls back for it, so every instance can have a count of its own
+void COUNT_QUANTUM(int instance, void *counts)
+{
+	((int*)counts)[instance]++;
+}
+
+// Every instance of a fleet has to end up exactly where running it on its own does, whichever workers ran it
+void TEST_FLEET()
+{
+	GameBoy *current = gb;
+	fleet *instances = createFleet(TEST_FLEET_INSTANCES, TEST_FLEET_WORKERS, NULL);
+	saveState *states = (saveState*)calloc(3, sizeof(saveState));
+	int counts[TEST_FLEET_INSTANCES] = { 0 };
+	int i;
+
+	assert(instances && states);
+	BUILD_BUSY_CARTRIDGE(fleetInstance(instances, 0)->rom);
+
+	for (i = 0; i < TEST_FLEET_INSTANCES; i++)
+	{
+		selectGameBoy(fleetInstance(instances, i));
+		setJoypad((BYTE)i);
+	}
+
+	// One instance starts on the last worker every time, the others spread out
+	setFleetAffinity(instances, 0, TEST_FLEET_WORKERS - 1);
+	setFleetCallback(instances, COUNT_QUANTUM, counts);
+	runFleet(instances, TEST_FLEET_QUANTA / 2);
+	runFleet(instances, TEST_FLEET_QUANTA - TEST_FLEET_QUANTA / 2);
+
+	assert(fleetTotalStats(instances).quanta == TEST_FLEET_INSTANCES * TEST_FLEET_QUANTA);
+	assert(fleetTotalStats(instances).cycles >= (unsigned long long)TEST_FLEET_INSTANCES * TEST_FLEET_QUANTA * CYCLES_PER_FRAME);
+
+	for (i = 0; i < TEST_FLEET_INSTANCES; i++)
+	{
+		GameBoy *alone = RUN_BUSY_GAMEBOY((BYTE)i, TEST_FLEET_QUANTA);
+
+		saveSnapshot(&states[0]);
+		destroyGameBoy(alone);
+
+		selectGameBoy(fleetInstance(instances, i));
+		saveSnapshot(&states[1]);
+
+		assert(counts[i] == TEST_FLEET_QUANTA);
+		assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+
+		// The buttons have to make a difference for the instances to be told apart
+		assert((i == 0) || (memcmp(&states[1], &states[2], sizeof(saveState)) != 0));
+		states[2] = states[1];
+	}
+
+	destroyFleet(instances);
+	free(states);
+	selectGameBoy(current);
+}
+
+#define TEST_BATCH_LANES 6
+#define TEST_BATCH_FRAMES 10
+
+/*
+	Every lane of a batch has to end up exactly where running it on its own does. Lanes come in pairs holding the
+	same buttons, so some run the whole way in the group and others leave it where they branch on what they read.
+*/
+void TEST_BATCH()
+{
+	GameBoy *current = gb;
+	batch *lanes = createBatch(TEST_BATCH_LANES, NULL);
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	batchStats stats;
+	int i, frame;
+
+	assert(lanes && states);
+	BUILD_BUSY_CARTRIDGE(batchInstance(lanes, 0)->rom);
+
+	for (i = 0; i < TEST_BATCH_LANES; i++)
+	{
+		selectGameBoy(batchInstance(lanes, i));
+		setJoypad((BYTE)(i / 2));
+	}
+
+	for (frame = 0; frame < TEST_BATCH_FRAMES; frame++)
+	{
+		runBatch(lanes, CYCLES_PER_FRAME);
+	}
+
+	stats = getBatchStats(lanes);
+	assert(stats.runs == TEST_BATCH_FRAMES);
+	assert(stats.vectorSteps > 0);
+	assert(stats.divergences > 0);
+
+	for (i = 0; i < TEST_BATCH_LANES; i++)
+	{
+		GameBoy *alone = RUN_BUSY_GAMEBOY((BYTE)(i / 2), TEST_BATCH_FRAMES);
+
+		saveSnapshot(&states[0]);
+		destroyGameBoy(alone);
+
+		selectGameBoy(batchInstance(lanes, i));
+		saveSnapshot(&states[1]);
+		assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+	}
+
+	destroyBatch(lanes);
+	free(states);
+	selectGameBoy(current);
+}
+
+#define TEST_SAVE_STATE_FRAMES 5
+#define TEST_SAVE_STATE_FILE "TEST_SAVE_STATE.sav"
+
+/*
+	Running on from a loaded state has to end up exactly where running on from the snapshot did, whether the state
+	comes from memory or a file, which engine runs on and which instance it is loaded into. The snapshot is taken
+	partway into a frame so the gpu, the timers and the events are somewhere in the middle too.
+*/
+void TEST_SAVE_STATE()
+{
+	GameBoy *current = gb;
+	GameBoy *instance = RUN_BUSY_GAMEBOY(0, TEST_SAVE_STATE_FRAMES);
+	GameBoy *other;
+	saveState *states = (saveState*)calloc(3, sizeof(saveState));
+	int engine;
+
+	assert(states);
+	cpuRun(CYCLES_PER_FRAME / 3);
+	saveSnapshot(&states[0]);
+	assert(writeSaveState(TEST_SAVE_STATE_FILE));
+
+	RUN_FRAMES(TEST_SAVE_STATE_FRAMES);
+	saveSnapshot(&states[1]);
+
+	for (engine = 0; engine <= ENGINE_JIT; engine++)
+	{
+		assert(loadSnapshot(&states[0]));
+		mEngine = (cpuEngine)engine;
+		RUN_FRAMES(TEST_SAVE_STATE_FRAMES);
+		saveSnapshot(&states[2]);
+		assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+	}
+
+	other = RUN_BUSY_GAMEBOY(JOYPAD_START, TEST_SAVE_STATE_FRAMES * 2);
+	assert(readSaveState(TEST_SAVE_STATE_FILE));
+	remove(TEST_SAVE_STATE_FILE);
+	RUN_FRAMES(TEST_SAVE_STATE_FRAMES);
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	// States from another version or another cartridge are turned down without touching the instance
+	states[0].machine.version++;
+	assert(!loadSnapshot(&states[0]));
+	states[0].machine.version--;
+	states[0].machine.title[0] ^= 0xFF;
+	assert(!loadSnapshot(&states[0]));
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	destroyGameBoy(other);
+	destroyGameBoy(instance);
+	free(states);
+	selectGameBoy(current);
+}
+
+#define TEST_FORK_FRAMES 10
+
+// A write after forking is only seen by the instance that made it, the other one still reads what was there
+void CHECK_FORK_WRITE(GameBoy *writer, GameBoy *other, WORD address)
+{
+	BYTE value;
+
+	selectGameBoy(writer);
+	value = readMemory(address);
+	writeMemory(address, value ^ 0xFF);
+	assert(readMemory(address) == (BYTE)(value ^ 0xFF));
+
+	selectGameBoy(other);
+	assert(readMemory(address) == value);
+
+	// Put back so both are the same again
+	selectGameBoy(writer);
+	writeMemory(address, value);
+}
+
+// Runs an instance with the busy cartridge for a while without buttons, then with the ones given, like the forks below
+void SNAPSHOT_BUSY_GAMEBOY(BYTE buttons, int frames, saveState *state)
+{
+	GameBoy *alone = RUN_BUSY_GAMEBOY(0, TEST_FORK_FRAMES);
+
+	setJoypad(buttons);
+	RUN_FRAMES(frames);
+	saveSnapshot(state);
+	destroyGameBoy(alone);
+}
+
+/*
+	A fork starts exactly where the instance it was forked from is and from then on neither sees what the other
+	writes, to memory they still share or not. A fork of a fork keeps running after the one in between is gone.
+*/
+void TEST_FORK()
+{
+	GameBoy *current = gb;
+	GameBoy *forks[2];
+	GameBoy *grandchild;
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	BYTE buttons[2] = { JOYPAD_A, JOYPAD_B };
+	int i, frame;
+
+	forks[0] = RUN_BUSY_GAMEBOY(0, TEST_FORK_FRAMES);
+	forks[1] = forkGameBoy(forks[0]);
+	assert(forks[1] && states);
+
+	saveSnapshot(&states[0]);
+	selectGameBoy(forks[1]);
+	saveSnapshot(&states[1]);
+	assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+
+	CHECK_FORK_WRITE(forks[1], forks[0], 0xD000);
+	CHECK_FORK_WRITE(forks[0], forks[1], 0xC000);
+	CHECK_FORK_WRITE(forks[1], forks[0], 0xFF80);
+
+	// Taking turns frame by frame, with different buttons so they write different bytes all over WRAM
+	for (frame = 0; frame < TEST_FORK_FRAMES; frame++)
+	{
+		for (i = 0; i < 2; i++)
+		{
+			selectGameBoy(forks[i]);
+			setJoypad(buttons[i]);
+			cpuRun(CYCLES_PER_FRAME);
+		}
+	}
+
+	for (i = 0; i < 2; i++)
+	{
+		SNAPSHOT_BUSY_GAMEBOY(buttons[i], TEST_FORK_FRAMES, &states[0]);
+		selectGameBoy(forks[i]);
+		saveSnapshot(&states[1]);
+		assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+	}
+
+	grandchild = forkGameBoy(forks[1]);
+	assert(grandchild);
+	destroyGameBoy(forks[1]);
+
+	selectGameBoy(grandchild);
+	RUN_FRAMES(TEST_FORK_FRAMES);
+	saveSnapshot(&states[1]);
+	SNAPSHOT_BUSY_GAMEBOY(buttons[1], TEST_FORK_FRAMES * 2, &states[0]);
+	assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+
+	// The instance that loaded the cartridge goes last
+	destroyGameBoy(grandchild);
+	destroyGameBoy(forks[0]);
+	free(states);
+	selectGameBoy(current);
+}
+
+#define TEST_DELTA_STATES_FRAMES 8
+
+/*
+	A keyframe and the deltas after it load back to exactly where running ended, and running on from any point in
+	the chain ends there too, whatever the engine. A delta only holds the pages written since the one before it.
+*/
+void TEST_DELTA_STATES()
+{
+	GameBoy *current = gb;
+	GameBoy *instance = RUN_BUSY_GAMEBOY(JOYPAD_A, TEST_DELTA_STATES_FRAMES);
+	saveState *states = (saveState*)calloc(3, sizeof(saveState));
+	deltaState *deltas = (deltaState*)malloc(TEST_DELTA_STATES_FRAMES * sizeof(deltaState));
+	int engine, frame, loaded;
+
+	assert(states && deltas);
+	saveKeyframe(&states[0]);
+	for (frame = 0; frame < TEST_DELTA_STATES_FRAMES; frame++)
+	{
+		// Uneven so the deltas also start and end partway through a frame
+		cpuRun(CYCLES_PER_FRAME + frame * 1000);
+		assert(saveDelta(&deltas[frame]));
+		assert(deltas[frame].pageCount > 2);
+	}
+	saveSnapshot(&states[1]);
+
+	assert(loadSnapshot(&states[0]));
+	for (frame = 0; frame < TEST_DELTA_STATES_FRAMES; frame++)
+	{
+		assert(loadDelta(&deltas[frame]));
+	}
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	for (engine = 0; engine <= ENGINE_JIT; engine++)
+	{
+		loaded = TEST_DELTA_STATES_FRAMES / 2 + engine - 1;
+		assert(loadSnapshot(&states[0]));
+		for (frame = 0; frame < loaded; frame++)
+		{
+			assert(loadDelta(&deltas[frame]));
+		}
+
+		mEngine = (cpuEngine)engine;
+		for (; frame < TEST_DELTA_STATES_FRAMES; frame++)
+		{
+			cpuRun(CYCLES_PER_FRAME + frame * 1000);
+		}
+		mEngine = ENGINE_INTERPRETER;
+
+		saveSnapshot(&states[2]);
+		assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+	}
+
+	// One byte written is its page on top of OAM and the I/O ports, which are always kept
+	saveKeyframe(&states[0]);
+	writeMemory(0xC123, readMemory(0xC123) ^ 0xFF);
+	assert(saveDelta(&deltas[0]));
+	assert(deltas[0].pageCount == 3);
+	assert(deltas[0].pageMask[0xC1 >> 3] & (1 << (0xC1 & 7)));
+	assert(DELTA_STATE_SIZE(&deltas[0]) == offsetof(deltaState, data) + 3 * 0x100);
+
+	assert(loadSnapshot(&states[0]));
+	assert(loadDelta(&deltas[0]));
+	assert(readMemory(0xC123) == (BYTE)(states[0].memory[0xC123] ^ 0xFF));
+
+	destroyGameBoy(instance);
+	free(deltas);
+	free(states);
+	selectGameBoy(current);
+}
+
+#define TEST_REWIND_FRAMES 12
+#define TEST_REWIND_KEPT 4
+#define TEST_REWIND_BYTES (1 << 20)
+
+/*
+	Going back to a recorded frame, by number or a step at a time, puts the instance exactly where it was when that
+	frame was recorded, even from partway into a frame. Recording goes on from a frame rewound to, and a rewinder
+	that keeps fewer frames turns down the ones it dropped without changing anything.
+*/
+void TEST_REWIND()
+{
+	GameBoy *current = gb;
+	GameBoy *instance = RUN_BUSY_GAMEBOY(JOYPAD_A, 1);
+	rewinder *recorder = createRewinder(instance, TEST_REWIND_FRAMES, TEST_REWIND_BYTES);
+	saveState *states = (saveState*)calloc(TEST_REWIND_FRAMES + 1, sizeof(saveState));
+	saveState *check = &states[TEST_REWIND_FRAMES];
+	int frame;
+
+	assert(recorder && states);
+	for (frame = 0; frame < TEST_REWIND_FRAMES; frame++)
+	{
+		if (frame)
+		{
+			cpuRun(CYCLES_PER_FRAME);
+		}
+		recordRewindFrame(recorder);
+		saveSnapshot(&states[frame]);
+	}
+	assert(newestRewindFrame(recorder) == TEST_REWIND_FRAMES - 1);
+	assert(oldestRewindFrame(recorder) == 0);
+	assert(rewindBytes(recorder) > 0);
+
+	// Halfway into a frame that wasn't recorded
+	cpuRun(CYCLES_PER_FRAME / 2);
+	assert(stepBack(recorder));
+	saveSnapshot(check);
+	assert(memcmp(check, &states[TEST_REWIND_FRAMES - 2], sizeof(saveState)) == 0);
+
+	assert(rewindToFrame(recorder, TEST_REWIND_FRAMES / 2));
+	saveSnapshot(check);
+	assert(memcmp(check, &states[TEST_REWIND_FRAMES / 2], sizeof(saveState)) == 0);
+	assert(newestRewindFrame(recorder) == TEST_REWIND_FRAMES / 2);
+	assert(!rewindToFrame(recorder, TEST_REWIND_FRAMES / 2 + 1));
+
+	// Recording again from here ends up where the first run did, and the new frames step back the same way
+	for (frame = TEST_REWIND_FRAMES / 2 + 1; frame < TEST_REWIND_FRAMES; frame++)
+	{
+		cpuRun(CYCLES_PER_FRAME);
+		recordRewindFrame(recorder);
+	}
+	saveSnapshot(check);
+	assert(memcmp(check, &states[TEST_REWIND_FRAMES - 1], sizeof(saveState)) == 0);
+
+	for (frame = TEST_REWIND_FRAMES - 2; frame >= 0; frame--)
+	{
+		assert(stepBack(recorder));
+		saveSnapshot(check);
+		assert(memcmp(check, &states[frame], sizeof(saveState)) == 0);
+	}
+	assert(!stepBack(recorder));
+	destroyRewinder(recorder);
+
+	recorder = createRewinder(instance, TEST_REWIND_KEPT, TEST_REWIND_BYTES);
+	assert(recorder);
+	for (frame = 0; frame < TEST_REWIND_FRAMES; frame++)
+	{
+		if (frame)
+		{
+			cpuRun(CYCLES_PER_FRAME);
+		}
+		recordRewindFrame(recorder);
+	}
+	assert(oldestRewindFrame(recorder) == TEST_REWIND_FRAMES - TEST_REWIND_KEPT - 1);
+	assert(!rewindToFrame(recorder, TEST_REWIND_FRAMES - TEST_REWIND_KEPT - 2));
+	saveSnapshot(check);
+	assert(memcmp(check, &states[TEST_REWIND_FRAMES - 1], sizeof(saveState)) == 0);
+
+	assert(rewindToFrame(recorder, TEST_REWIND_FRAMES - TEST_REWIND_KEPT - 1));
+	saveSnapshot(check);
+	assert(memcmp(check, &states[TEST_REWIND_FRAMES - TEST_REWIND_KEPT - 1], sizeof(saveState)) == 0);
+
+	destroyRewinder(recorder);
+	destroyGameBoy(instance);
+	free(states);
+	selectGameBoy(current);
+}
+
+#define TEST_MOVIE_FRAMES 10
+#define TEST_MOVIE_FILE "TEST_MOVIE.gbm"
+
+/*
+	A movie with buttons pressed and let go partway through frames replays to exactly where recording ended on
+	every engine, also after a trip through a file. A replay that gets other input doesn't match, and a movie
+	isn't replayed at all on another cartridge.
+*/
+void TEST_MOVIE()
+{
+	GameBoy *current = gb;
+	GameBoy *instance = RUN_BUSY_GAMEBOY(0, 2);
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	movie *recorded;
+	movie *replayed;
+	int frame, engine;
+
+	// What readROM would work out from the header of a 32 kb cartridge, so the movie hashes the program
+	mCartridgeHeader.romSize = 0x8000;
+
+	recorded = recordMovie();
+	assert(recorded && states);
+	for (frame = 0; frame < TEST_MOVIE_FRAMES; frame++)
+	{
+		int split = (frame * 7919) % CYCLES_PER_FRAME;
+
+		cpuRun(split);
+		assert(recordJoypad(recorded, getJoypad() ^ (1 << (frame % 4))));
+		cpuRun(CYCLES_PER_FRAME - split);
+	}
+	endMovie(recorded);
+	saveSnapshot(&states[0]);
+	assert(movieInputs(recorded) == TEST_MOVIE_FRAMES);
+
+	for (engine = 0; engine <= ENGINE_JIT; engine++)
+	{
+		mEngine = (cpuEngine)engine;
+		assert(playMovie(recorded));
+		saveSnapshot(&states[1]);
+		assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+	}
+	mEngine = ENGINE_INTERPRETER;
+
+	assert(writeMovie(recorded, TEST_MOVIE_FILE));
+	replayed = readMovie(TEST_MOVIE_FILE);
+	remove(TEST_MOVIE_FILE);
+	assert(replayed);
+	assert(movieInputs(replayed) == movieInputs(recorded));
+	assert(movieLength(replayed) == movieLength(recorded));
+	assert(playMovie(replayed));
+
+	// A button the movie doesn't have, held until its next input
+	assert(startReplay(replayed));
+	assert(replayMovie(replayed, CYCLES_PER_FRAME / 2));
+	setJoypad(getJoypad() ^ JOYPAD_START);
+	while (replayMovie(replayed, CYCLES_PER_FRAME));
+	assert(!replayMatches(replayed));
+
+	mCartridge[0x7FFF] ^= 0xFF;
+	assert(!startReplay(replayed));
+	assert(!playMovie(replayed));
+	mCartridge[0x7FFF] ^= 0xFF;
+	assert(playMovie(replayed));
+
+	destroyMovie(replayed);
+	destroyMovie(recorded);
+	destroyGameBoy(instance);
+	free(states);
+	selectGameBoy(current);
+}
+
+// A new instance running the cartridge, run on for the given frames. NULL when it can't be made or the cartridge
+// can't be read, with the instance that was current before still selected
+GameBoy *LOAD_BENCHMARK_GAMEBOY(char *rom, int frames)
+{
+	GameBoy *current = gb;
+	GameBoy *instance = createGameBoy();
+
+	if (!instance || !readROM(rom))
+	{
+		destroyGameBoy(instance);
+		selectGameBoy(current);
+		return NULL;
+	}
+
+	RUN_FRAMES(frames);
+	return instance;
+}
+
+/*
+	Times every helper against its table over all inputs and writes the results to BENCHMARK_ALU.txt.
+	Meant for the default build, with TABLE_ALU defined DAA is the table on both sides.
+*/
+void BENCHMARK_ALU()
+{
+	FILE *fp;
+	int operation, table, round, value;
+	double start, seconds[2][TABLE_OPERATIONS];
+	BYTE sink = 0;
+
+	initializeAluTables();
+
+	for (operation = 0; operation < TABLE_OPERATIONS; operation++)
+	{
+		for (table = 0; table < 2; table++)
+		{
+			SET_ALU_INPUTS(0, 0);
+			start = stopwatchSeconds();
+
+			for (round = 0; round < 256; round++)
+			{
+				for (value = 0; value < 0x10000; value++)
+				{
+					// The flags and A carry on from one call to the next so the branches can't be predicted from a pattern
+					registerAF.hi ^= (BYTE)(value >> 8);
+					sink ^= RUN_TABLE_ALU(operation, table, (BYTE)value);
+				}
+			}
+
+			seconds[table][operation] = stopwatchSeconds() - start;
+		}
+	}
+
+	fopen_s(&fp, "BENCHMARK_ALU.txt", "w");
+	fprintf(fp, "operation  branches  tables  (seconds for %d calls, %d)\n", 256 * 0x10000, sink);
+	for (operation = 0; operation < TABLE_OPERATIONS; operation++)
+	{
+		fprintf(fp, "%9d  %8.3f  %6.3f\n", operation, seconds[0][operation], seconds[1][operation]);
+	}
+	fclose(fp);
+}
+
+#define BENCHMARK_FLEET_INSTANCES 64
+#define BENCHMARK_FLEET_FRAMES 600
+
+// Runs a fleet of the cartridge on one worker and on one per core and writes both to BENCHMARK_FLEET.txt
+void BENCHMARK_FLEET(char *rom)
+{
+	int workers[2] = { 1, 0 };
+	FILE *fp;
+	int i;
+
+	fopen_s(&fp, "BENCHMARK_FLEET.txt", "w");
+	for (i = 0; i < 2; i++)
+	{
+		fleet *instances = createFleet(BENCHMARK_FLEET_INSTANCES, workers[i], rom);
+		if (!instances)
+		{
+			break;
+		}
+
+		runFleet(instances, BENCHMARK_FLEET_FRAMES);
+		writeFleetStats(instances, fp);
+		destroyFleet(instances);
+	}
+	fclose(fp);
+}
+
+#define BENCHMARK_BATCH_LANES 256
+#define BENCHMARK_BATCH_FRAMES 60
+
+/*
+	Runs the cartridge on a batch and on as many instances one after another, with the interpreter and
+	the block cache, and writes the frames per second of each to BENCHMARK_BATCH.txt. Every lane has to
+	end up with the same memory as its scalar instance.
+*/
+void BENCHMARK_BATCH(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy **scalar = (GameBoy**)calloc(BENCHMARK_BATCH_LANES, sizeof(GameBoy*));
+	batch *lanes = createBatch(BENCHMARK_BATCH_LANES, rom);
+	double seconds[3], start;
+	batchStats stats;
+	FILE *fp;
+	int engine, i, frame;
+
+	if (!scalar || !lanes)
+	{
+		free(scalar);
+		destroyBatch(lanes);
+		return;
+	}
+
+	for (engine = ENGINE_INTERPRETER; engine <= ENGINE_BLOCK_CACHE; engine++)
+	{
+		for (i = 0; i < BENCHMARK_BATCH_LANES; i++)
+		{
+			scalar[i] = createGameBoy();
+			shareCartridge(batchInstance(lanes, 0));
+			mEngine = engine;
+		}
+
+		start = stopwatchSeconds();
+		for (i = 0; i < BENCHMARK_BATCH_LANES; i++)
+		{
+			selectGameBoy(scalar[i]);
+			for (frame = 0; frame < BENCHMARK_BATCH_FRAMES; frame++)
+			{
+				cpuRun(CYCLES_PER_FRAME);
+			}
+		}
+		seconds[engine - ENGINE_INTERPRETER] = stopwatchSeconds() - start;
+
+		// The last pass is kept to check the lanes against
+		if (engine != ENGINE_BLOCK_CACHE)
+		{
+			for (i = 0; i < BENCHMARK_BATCH_LANES; i++)
+			{
+				destroyGameBoy(scalar[i]);
+			}
+		}
+	}
+
+	start = stopwatchSeconds();
+	for (frame = 0; frame < BENCHMARK_BATCH_FRAMES; frame++)
+	{
+		runBatch(lanes, CYCLES_PER_FRAME);
+	}
+	seconds[2] = stopwatchSeconds() - start;
+
+	for (i = 0; i < BENCHMARK_BATCH_LANES; i++)
+	{
+		assert(memcmp(batchInstance(lanes, i)->memory, scalar[i]->memory, sizeof(scalar[i]->memory)) == 0);
+		destroyGameBoy(scalar[i]);
+	}
+
+	stats = getBatchStats(lanes);
+	fopen_s(&fp, "BENCHMARK_BATCH.txt", "w");
+	fprintf(fp, "%d instances, %d frames\n", BENCHMARK_BATCH_LANES, BENCHMARK_BATCH_FRAMES);
+	fprintf(fp, "interpreter  %10.1f frames/s\n", BENCHMARK_BATCH_LANES * BENCHMARK_BATCH_FRAMES / seconds[0]);
+	fprintf(fp, "block cache  %10.1f frames/s\n", BENCHMARK_BATCH_LANES * BENCHMARK_BATCH_FRAMES / seconds[1]);
+	fprintf(fp, "batch        %10.1f frames/s\n", BENCHMARK_BATCH_LANES * BENCHMARK_BATCH_FRAMES / seconds[2]);
+	fprintf(fp, "vector steps %llu, scalar steps %llu, lanes per run %.1f, divergences %llu\n",
+		stats.vectorSteps, stats.scalarSteps, (double)stats.groupedLanes / stats.runs, stats.divergences);
+	fclose(fp);
+
+	free(scalar);
+	destroyBatch(lanes);
+	selectGameBoy(current);
+}
+
+#define BENCHMARK_SAVE_STATE_FRAMES 60
+#define BENCHMARK_SAVE_STATE_ROUNDS 10000
+
+/*
+	Checks that running on from a loaded state, from memory or from a file, ends up exactly where running on
+	from the snapshot did, then times saving and loading and writes both to BENCHMARK_SAVE_STATE.txt.
+*/
+void BENCHMARK_SAVE_STATE(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy *instance = LOAD_BENCHMARK_GAMEBOY(rom, BENCHMARK_SAVE_STATE_FRAMES);
+	saveState *states = (saveState*)calloc(3, sizeof(saveState));
+	double start, saveSeconds, loadSeconds;
+	FILE *fp;
+	int round;
+
+	if (!instance || !states)
+	{
+		free(states);
+		destroyGameBoy(instance);
+		selectGameBoy(current);
+		return;
+	}
+
+	saveSnapshot(&states[0]);
+	assert(writeSaveState("BENCHMARK_SAVE_STATE.sav"));
+	RUN_FRAMES(BENCHMARK_SAVE_STATE_FRAMES);
+	saveSnapshot(&states[1]);
+
+	assert(loadSnapshot(&states[0]));
+	RUN_FRAMES(BENCHMARK_SAVE_STATE_FRAMES);
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	assert(readSaveState("BENCHMARK_SAVE_STATE.sav"));
+	remove("BENCHMARK_SAVE_STATE.sav");
+	RUN_FRAMES(BENCHMARK_SAVE_STATE_FRAMES);
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	start = stopwatchSeconds();
+	for (round = 0; round < BENCHMARK_SAVE_STATE_ROUNDS; round++)
+	{
+		saveSnapshot(&states[round & 1]);
+	}
+	saveSeconds = stopwatchSeconds() - start;
+
+	start = stopwatchSeconds();
+	for (round = 0; round < BENCHMARK_SAVE_STATE_ROUNDS; round++)
+	{
+		loadSnapshot(&states[round & 1]);
+	}
+	loadSeconds = stopwatchSeconds() - start;
+
+	fopen_s(&fp, "BENCHMARK_SAVE_STATE.txt", "w");
+	fprintf(fp, "%u bytes per state\n", (unsigned int)sizeof(saveState));
+	fprintf(fp, "save %8.3f us\n", saveSeconds * 1000000 / BENCHMARK_SAVE_STATE_ROUNDS);
+	fprintf(fp, "load %8.3f us\n", loadSeconds * 1000000 / BENCHMARK_SAVE_STATE_ROUNDS);
+	fclose(fp);
+
+	free(states);
+	destroyGameBoy(instance);
+	selectGameBoy(current);
+}
+
+#define BENCHMARK_FORK_FRAMES 60
+#define BENCHMARK_FORK_ROUNDS 1000
+
+/*
+	Forks an instance and checks the fork and the original end up in the same state after running on the
+	same frames, writing to memory they share all the while. Then times forking and writes it to BENCHMARK_FORK.txt.
+*/
+void BENCHMARK_FORK(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy *parent = LOAD_BENCHMARK_GAMEBOY(rom, BENCHMARK_FORK_FRAMES);
+	GameBoy *child;
+	saveState *states = (saveState*)calloc(2, sizeof(saveState));
+	double start, seconds;
+	FILE *fp;
+	int frame, round;
+
+	if (!parent || !states)
+	{
+		free(states);
+		destroyGameBoy(parent);
+		selectGameBoy(current);
+		return;
+	}
+
+	child = forkGameBoy(parent);
+	assert(child);
+
+	for (frame = 0; frame < BENCHMARK_FORK_FRAMES; frame++)
+	{
+		selectGameBoy(parent);
+		cpuRun(CYCLES_PER_FRAME);
+		selectGameBoy(child);
+		cpuRun(CYCLES_PER_FRAME);
+	}
+
+	saveSnapshot(&states[0]);
+	selectGameBoy(parent);
+	saveSnapshot(&states[1]);
+	assert(memcmp(&states[0], &states[1], sizeof(saveState)) == 0);
+	destroyGameBoy(child);
+
+	start = stopwatchSeconds();
+	for (round = 0; round < BENCHMARK_FORK_ROUNDS; round++)
+	{
+		destroyGameBoy(forkGameBoy(parent));
+	}
+	seconds = stopwatchSeconds() - start;
+
+	fopen_s(&fp, "BENCHMARK_FORK.txt", "w");
+	fprintf(fp, "fork and destroy %8.3f us\n", seconds * 1000000 / BENCHMARK_FORK_ROUNDS);
+	fclose(fp);
+
+	free(states);
+	destroyGameBoy(parent);
+	selectGameBoy(current);
+}
+
+#define BENCHMARK_DELTA_STATES_FRAMES 60
+
+/*
+	Saves a keyframe and a delta after every frame for BENCHMARK_DELTA_STATES_FRAMES frames, then checks the
+	keyframe and all the deltas load back to exactly where running ended, and that running on from halfway through
+	the chain ends there too. Writes how big the deltas are next to a full state to BENCHMARK_DELTA_STATES.txt.
+*/
+void BENCHMARK_DELTA_STATES(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy *instance = LOAD_BENCHMARK_GAMEBOY(rom, BENCHMARK_DELTA_STATES_FRAMES);
+	saveState *states = (saveState*)calloc(3, sizeof(saveState));
+	deltaState *deltas = (deltaState*)malloc(BENCHMARK_DELTA_STATES_FRAMES * sizeof(deltaState));
+	double start, saveSeconds = 0, loadSeconds;
+	size_t bytes = 0, largest = 0;
+	FILE *fp;
+	int frame;
+
+	if (!instance || !states || !deltas)
+	{
+		free(deltas);
+		free(states);
+		destroyGameBoy(instance);
+		selectGameBoy(current);
+		return;
+	}
+
+	saveKeyframe(&states[0]);
+	for (frame = 0; frame < BENCHMARK_DELTA_STATES_FRAMES; frame++)
+	{
+		cpuRun(CYCLES_PER_FRAME);
+
+		start = stopwatchSeconds();
+		assert(saveDelta(&deltas[frame]));
+		saveSeconds += stopwatchSeconds() - start;
+
+		bytes += DELTA_STATE_SIZE(&deltas[frame]);
+		if (DELTA_STATE_SIZE(&deltas[frame]) > largest)
+		{
+			largest = DELTA_STATE_SIZE(&deltas[frame]);
+		}
+	}
+	saveSnapshot(&states[1]);
+
+	assert(loadSnapshot(&states[0]));
+	start = stopwatchSeconds();
+	for (frame = 0; frame < BENCHMARK_DELTA_STATES_FRAMES; frame++)
+	{
+		assert(loadDelta(&deltas[frame]));
+	}
+	loadSeconds = stopwatchSeconds() - start;
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	assert(loadSnapshot(&states[0]));
+	for (frame = 0; frame < BENCHMARK_DELTA_STATES_FRAMES / 2; frame++)
+	{
+		assert(loadDelta(&deltas[frame]));
+	}
+	for (; frame < BENCHMARK_DELTA_STATES_FRAMES; frame++)
+	{
+		cpuRun(CYCLES_PER_FRAME);
+	}
+	saveSnapshot(&states[2]);
+	assert(memcmp(&states[1], &states[2], sizeof(saveState)) == 0);
+
+	fopen_s(&fp, "BENCHMARK_DELTA_STATES.txt", "w");
+	fprintf(fp, "%u bytes per full state\n", (unsigned int)sizeof(saveState));
+	fprintf(fp, "%u bytes per delta on average, %u at most\n", (unsigned int)(bytes / BENCHMARK_DELTA_STATES_FRAMES), (unsigned int)largest);
+	fprintf(fp, "save %8.3f us\n", saveSeconds * 1000000 / BENCHMARK_DELTA_STATES_FRAMES);
+	fprintf(fp, "load %8.3f us\n", loadSeconds * 1000000 / BENCHMARK_DELTA_STATES_FRAMES);
+	fclose(fp);
+
+	free(deltas);
+	free(states);
+	destroyGameBoy(instance);
+	selectGameBoy(current);
+}
+
+#define BENCHMARK_REWIND_FRAMES 600
+#define BENCHMARK_REWIND_CHECK_EVERY 60
+#define BENCHMARK_REWIND_BYTES (16 << 20)
+
+/*
+	Records BENCHMARK_REWIND_FRAMES frames into a rewinder, then checks that rewinding to every one of a few of
+	them from the newest back gets there exactly, that running on from a frame rewound to ends up where running
+	the first time did and that a step back goes back one frame. Writes how big the frames are and how long
+	recording and stepping back take to BENCHMARK_REWIND.txt.
+*/
+void BENCHMARK_REWIND(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy *instance = LOAD_BENCHMARK_GAMEBOY(rom, 0);
+	rewinder *recorder = NULL;
+	saveState *states = (saveState*)calloc(BENCHMARK_REWIND_FRAMES / BENCHMARK_REWIND_CHECK_EVERY + 2, sizeof(saveState));
+	saveState *check = &states[BENCHMARK_REWIND_FRAMES / BENCHMARK_REWIND_CHECK_EVERY];
+	saveState *stepped = &states[BENCHMARK_REWIND_FRAMES / BENCHMARK_REWIND_CHECK_EVERY + 1];
+	double start, recordSeconds = 0, stepSeconds;
+	size_t bytes;
+	FILE *fp;
+	int frame;
+
+	if (instance && states)
+	{
+		recorder = createRewinder(instance, BENCHMARK_REWIND_FRAMES, BENCHMARK_REWIND_BYTES);
+	}
+
+	if (!recorder)
+	{
+		free(states);
+		destroyGameBoy(instance);
+		selectGameBoy(current);
+		return;
+	}
+
+	for (frame = 0; frame < BENCHMARK_REWIND_FRAMES; frame++)
+	{
+		if (frame)
+		{
+			cpuRun(CYCLES_PER_FRAME);
+		}
+
+		start = stopwatchSeconds();
+		recordRewindFrame(recorder);
+		recordSeconds += stopwatchSeconds() - start;
+
+		if (frame % BENCHMARK_REWIND_CHECK_EVERY == 0)
+		{
+			saveSnapshot(&states[frame / BENCHMARK_REWIND_CHECK_EVERY]);
+		}
+	}
+	bytes = rewindBytes(recorder);
+	assert(newestRewindFrame(recorder) == BENCHMARK_REWIND_FRAMES - 1);
+
+	// Halfway into a frame that wasn't recorded
+	cpuRun(CYCLES_PER_FRAME / 2);
+
+	for (frame = BENCHMARK_REWIND_FRAMES - BENCHMARK_REWIND_CHECK_EVERY; frame >= 0; frame -= BENCHMARK_REWIND_CHECK_EVERY)
+	{
+		assert(rewindToFrame(recorder, frame));
+		saveSnapshot(check);
+		assert(memcmp(check, &states[frame / BENCHMARK_REWIND_CHECK_EVERY], sizeof(saveState)) == 0);
+	}
+	assert(!stepBack(recorder));
+
+	for (frame = 1; frame <= BENCHMARK_REWIND_CHECK_EVERY; frame++)
+	{
+		cpuRun(CYCLES_PER_FRAME);
+		recordRewindFrame(recorder);
+
+		if (frame == BENCHMARK_REWIND_CHECK_EVERY - 1)
+		{
+			saveSnapshot(stepped);
+		}
+	}
+	saveSnapshot(check);
+	assert(memcmp(check, &states[1], sizeof(saveState)) == 0);
+
+	assert(stepBack(recorder));
+	saveSnapshot(check);
+	assert(memcmp(check, stepped, sizeof(saveState)) == 0);
+
+	start = stopwatchSeconds();
+	while (stepBack(recorder));
+	stepSeconds = stopwatchSeconds() - start;
+	assert(newestRewindFrame(recorder) == 0);
+
+	fopen_s(&fp, "BENCHMARK_REWIND.txt", "w");
+	fprintf(fp, "%u bytes per full state\n", (unsigned int)sizeof(saveState));
+	fprintf(fp, "%u bytes per frame on average\n", (unsigned int)(bytes / (BENCHMARK_REWIND_FRAMES - 1)));
+	fprintf(fp, "record %8.3f us\n", recordSeconds * 1000000 / BENCHMARK_REWIND_FRAMES);
+	fprintf(fp, "step back %8.3f us\n", stepSeconds * 1000000 / (BENCHMARK_REWIND_CHECK_EVERY - 1));
+	fclose(fp);
+
+	destroyRewinder(recorder);
+	free(states);
+	destroyGameBoy(instance);
+	selectGameBoy(current);
+}
+
+#define BENCHMARK_MOVIE_FRAMES 600
+
+/*
+	Records a movie of BENCHMARK_MOVIE_FRAMES frames with buttons pressed and let go on uneven cycles, writes it
+	to BENCHMARK_MOVIE.gbm and reads it back. Checks that it replays to exactly where recording ended on every
+	engine, then writes how fast the replay runs to BENCHMARK_MOVIE.txt.
+*/
+void BENCHMARK_MOVIE(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy *instance = LOAD_BENCHMARK_GAMEBOY(rom, 0);
+	movie *recorded = NULL;
+	movie *replayed = NULL;
+	cpuEngine recordedEngine;
+	double start, seconds;
+	FILE *fp;
+	int frame, engine;
+
+	if (instance)
+	{
+		recorded = recordMovie();
+	}
+
+	if (!recorded)
+	{
+		destroyGameBoy(instance);
+		selectGameBoy(current);
+		return;
+	}
+
+	recordedEngine = mEngine;
+	srand(BENCHMARK_MOVIE_FRAMES);
+	for (frame = 0; frame < BENCHMARK_MOVIE_FRAMES; frame++)
+	{
+		int split = rand() % CYCLES_PER_FRAME;
+
+		cpuRun(split);
+		if (rand() % 4 == 0)
+		{
+			assert(recordJoypad(recorded, getJoypad() ^ (1 << (rand() % 8))));
+		}
+		cpuRun(CYCLES_PER_FRAME - split);
+	}
+	endMovie(recorded);
+
+	assert(writeMovie(recorded, "BENCHMARK_MOVIE.gbm"));
+	replayed = readMovie("BENCHMARK_MOVIE.gbm");
+	remove("BENCHMARK_MOVIE.gbm");
+	assert(replayed);
+	assert(movieInputs(replayed) == movieInputs(recorded));
+
+	for (engine = 0; engine < ENGINE_COUNT; engine++)
+	{
+		mEngine = (cpuEngine)engine;
+		assert(playMovie(replayed));
+	}
+
+	mEngine = recordedEngine;
+	start = stopwatchSeconds();
+	assert(playMovie(replayed));
+	seconds = stopwatchSeconds() - start;
+
+	fopen_s(&fp, "BENCHMARK_MOVIE.txt", "w");
+	fprintf(fp, "%d inputs over %d frames\n", movieInputs(replayed), BENCHMARK_MOVIE_FRAMES);
+	fprintf(fp, "replay %8.1f frames/s\n", BENCHMARK_MOVIE_FRAMES / seconds);
+	fclose(fp);
+
+	destroyMovie(replayed);
+	destroyMovie(recorded);
+	destroyGameBoy(instance);
+	selectGameBoy(current);
+}
+
+/*
+	Runs every benchmark on the cartridge, each writes what it measured to its own BENCHMARK_*.txt in the working
+	directory. Returns 0 when the cartridge can't be read, the benchmarks assert like the tests do otherwise.
+*/
+int RUN_BENCHMARKS(char *rom)
+{
+	GameBoy *current = gb;
+	GameBoy *instance = LOAD_BENCHMARK_GAMEBOY(rom, 0);
+
+	if (!instance)
+	{
+		return 0;
+	}
+	destroyGameBoy(instance);
+	selectGameBoy(current);
+
+	BENCHMARK_ALU();
+	BENCHMARK_FLEET(rom);
+	BENCHMARK_BATCH(rom);
+	BENCHMARK_SAVE_STATE(rom);
+	BENCHMARK_FORK(rom);
+	BENCHMARK_DELTA_STATES(rom);
+	BENCHMARK_REWIND(rom);
+	BENCHMARK_MOVIE(rom);
+
+	return 1;
+}
+
+void TEST_OPCODES()
+{
+	// TEST_SPECIAL();
+	TEST_HL_SP();
+	TEST_LD();
+	TEST_8BIT_LOGIC();
+	TEST_16BIT_LOGIC();
+	TEST_JR_JP_CALL_RET_RST();
+	TEST_A_HL();
+	TEST_MISC();
+	TEST_BIT_OPS();
+	TEST_LAZY_FLAGS();
+	TEST_TABLE_ALU();
+	TEST_TIMERS();
+	TEST_INTERRUPTS();
+	TEST_HALT();
+	TEST_BLOCK_CACHE();
+	TEST_IDLE_LOOPS();
+	TEST_JIT_VERIFY();
+	TEST_MEMORY_MAP();
+	TEST_IO();
+	TEST_GPU_CATCH_UP();
+	TEST_FLEET();
+	TEST_BATCH();
+	TEST_SAVE_STATE();
+	TEST_FORK();
+	TEST_DELTA_STATES();
+	TEST_REWIND();
+	TEST_MOVIE();
+#ifdef RECOMPILED_CARTRIDGE
+	TEST_RECOMPILED();
+#endif
 }
\ No newline at end of file
@@ -1,91 +1,167 @@
-#include "hardware.h"
-#include "memory.h"
-#include "timers.h"
-#include "interrupts.h"
-
-#define DIVIDER 0xFF04
-#define TIMA    0xFF05
-#define TMA     0xFF06
-/*
-	Bit 2 of TMC is timer control - 0: Timer Stop, 1: Timer Start
-	Bit 0 and 1 of TMC is input clock select. Frequency is determined by this value
-*/
-#define TMC     0xFF07
-
-#define CLOCKSPEED 4194304
-
-#define FREQUENCY_0 4096
-#define FREQUENCY_1 262144
-#define FREQUENCY_2 65536
-#define FREQUENCY_3 16382
-
-int mDividerCounter = 0;
-
-// Default frequency is frequency 0, 4096
-int mTimerCounter = CLOCKSPEED / FREQUENCY_0;
-
-void timerStep()
-{
-	dividerRegister(clock);
-	if ((readMemory(TMC) >> 2) & 1)
-	{
-		mTimerCounter -= clock;
-		if (mTimerCounter <= 0)
-		{
-			setFrequency();
-			if (readMemory(TIMA) == 255)
-			{
-				writeMemory(TIMA, readMemory(TMA));
-				if (interrupt.enable && INTERRUPTS_TIMER)
-				{
-					interrupt.flags |= INTERRUPTS_TIMER;
-				}
-			}
-			else
-			{
-				cpu[TIMA]++;
-			}
-		}
-	}
-}
-
-BYTE getFrequency()
-{
-	return readMemory(TMC) & (BIT_0 || BIT_1);
-}
-
-void setFrequency()
-{
-	BYTE f = getFrequency();
-	int frequency;
-	switch (f)
-	{
-	case 0:
-		frequency = FREQUENCY_0 ;
-		break;
-	case 1:
-		frequency = FREQUENCY_1;
-		break;
-	case 2:
-		frequency = FREQUENCY_2;
-		break;
-	case 3:
-		frequency = FREQUENCY_3;
-		break;
-	default:
-		frequency = FREQUENCY_0;
-		break;
-	}
-	mTimerCounter = CLOCKSPEED / frequency;
-}
-
-void dividerRegister(int cycles)
-{
-	mDividerCounter += cycles;
-	// 255 is the max value of 1 byte, and we need to make sure an overflow increments our divider register
-	if (mDividerCounter >= 255)
-	{
-		mDividerCounter = 0;
-		cpu[DIVIDER]++;
-	}
-}
+#include "hardware.h"
+#include "memory.h"
+#include "timers.h"
+#include "interrupts.h"
+#include "scheduler.h"
+#include "context.h"
+
+#define DIVIDER 0xFF04
+#define TIMA    0xFF05
+#define TMA     0xFF06
+/*
+	Bit 2 of TMC is timer control - 0: Timer Stop, 1: Timer Start
+	Bit 0 and 1 of TMC is input clock select. Frequency is determined by this value
+*/
+#define TMC     0xFF07
+
+#define CLOCKSPEED 4194304
+
+#define FREQUENCY_0 4096
+#define FREQUENCY_1 262144
+#define FREQUENCY_2 65536
+#define FREQUENCY_3 16384
+
+/*
+	The timers aren't counted up as time passes. DIV is the top byte of a 16 bit counter that goes up every
+	cycle, so it is worked out from how long ago it was reset. TIMA goes up every time the counter passes a
+	multiple of the timer period, so it is worked out from the value it was last given and how many of those
+	multiples clock has passed since. The only event is for the cycle TIMA overflows.
+*/
+
+int timerRunning()
+{
+	return (cpu[TMC] >> 2) & 1;
+}
+
+BYTE getFrequency()
+{
+	return cpu[TMC] & (BIT_0 | BIT_1);
+}
+
+// Cycles between two increments of TIMA
+CYCLES timerPeriod()
+{
+	switch (getFrequency())
+	{
+	case 1:
+		return CLOCKSPEED / FREQUENCY_1;
+	case 2:
+		return CLOCKSPEED / FREQUENCY_2;
+	case 3:
+		return CLOCKSPEED / FREQUENCY_3;
+	default:
+		return CLOCKSPEED / FREQUENCY_0;
+	}
+}
+
+// The cycle TIMA goes up for the nth time after from
+CYCLES timerTickCycle(CYCLES from, CYCLES ticks)
+{
+	CYCLES period = timerPeriod();
+
+	return mTimer.dividerStart + (((from - mTimer.dividerStart) / period) + ticks) * period;
+}
+
+// TIMA starts again from TMA after it overflows. IF is set whether or not IE lets the interrupt through
+void overflowTimer()
+{
+	mTimer.counter = cpu[TMA];
+	requestInterrupt(INTERRUPTS_TIMER);
+}
+
+// Brings TIMA up to clock, overflowing as many times as it would have in between
+void updateTimer()
+{
+	if (timerRunning())
+	{
+		CYCLES period = timerPeriod();
+		CYCLES ticks = ((clock - mTimer.dividerStart) / period) - ((mTimer.counterStart - mTimer.dividerStart) / period);
+
+		while (mTimer.counter + ticks > 0xFF)
+		{
+			ticks -= 0x100 - mTimer.counter;
+			overflowTimer();
+		}
+
+		mTimer.counter += (BYTE)ticks;
+	}
+
+	mTimer.counterStart = clock;
+}
+
+// Only called after updateTimer, TIMA is up to date at clock
+void scheduleTimer()
+{
+	if (timerRunning())
+	{
+		scheduleEvent(EVENT_TIMER, timerTickCycle(clock, 0x100 - mTimer.counter), timerStep);
+	}
+	else
+	{
+		cancelEvent(EVENT_TIMER);
+	}
+}
+
+void initializeTimers()
+{
+	mTimer.dividerStart = clock;
+	mTimer.counterStart = clock;
+	mTimer.counter = 0x00;
+
+	scheduleTimer();
+}
+
+// Called by the scheduler when TIMA overflows so the interrupt is raised on time
+void timerStep(CYCLES due)
+{
+	updateTimer();
+	scheduleTimer();
+}
+
+BYTE readDivider()
+{
+	return (BYTE)((clock - mTimer.dividerStart) >> 8);
+}
+
+// Writing to the divider register resets it
+void writeDivider(BYTE data)
+{
+	updateTimer();
+
+	// TIMA goes up when the counter bit it follows drops to 0, which resetting the counter can do as well
+	if (timerRunning() && ((clock - mTimer.dividerStart) & (timerPeriod() >> 1)))
+	{
+		if (mTimer.counter == 0xFF)
+		{
+			overflowTimer();
+		}
+		else
+		{
+			mTimer.counter++;
+		}
+	}
+
+	mTimer.dividerStart = clock;
+	scheduleTimer();
+}
+
+BYTE readTimerCounter()
+{
+	updateTimer();
+	return mTimer.counter;
+}
+
+void writeTimerCounter(BYTE data)
+{
+	updateTimer();
+	mTimer.counter = data;
+	scheduleTimer();
+}
+
+// Writing to TMC can start or stop the timer and change its frequency
+void writeTimerControl(BYTE data)
+{
+	updateTimer();
+	cpu[TMC] = data;
+	scheduleTimer();
+}